@@ -38,6 +38,8 @@ static int _ccl_match(jrx_ccl* ccl, jrx_char cp, jrx_char* previous, jrx_asserti
 
 int jrx_match_state_advance_min(jrx_match_state* ms, jrx_char cp, jrx_assertion assertions)
 {
+    dfa_check_budget(ms->dfa);
+
     jrx_dfa_state* state = dfa_get_state(ms->dfa, ms->state);
 
     if ( ! state )
@@ -117,4 +119,26 @@ void jrx_match_state_copy(const jrx_match_state* from, jrx_match_state* to) {
     to->cflags = from->cflags;
     // Skip fields only used by the full matcher.
     to->acc = from->acc;
+    to->prev_ms = 0;
+    to->next_ms = 0;
+
+    if ( to->dfa )
+        dfa_register_match_state(to->dfa, to);
+}
+
+void jrx_match_state_move(jrx_match_state* from, jrx_match_state* to)
+{
+    *to = *from;
+
+    // Take over the position in the DFA's list of match states.
+    if ( to->prev_ms )
+        to->prev_ms->next_ms = to;
+    else if ( to->dfa && to->dfa->match_states == from )
+        to->dfa->match_states = to;
+
+    if ( to->next_ms )
+        to->next_ms->prev_ms = to;
+
+    from->prev_ms = 0;
+    from->next_ms = 0;
 }
@@ -192,6 +192,7 @@ jrx_match_state* jrx_match_state_init(const jrx_regex_t* preg, jrx_offset begin,
     ms->tags1_size = 0;
     ms->tags2_size = 0;
     ms->cflags = preg->cflags;
+    dfa_register_match_state(dfa, ms);
 
     if ( (dfa->options & JRX_OPTION_STD_MATCHER) ) {
         ms->accepts = set_match_accept_create(0);
@@ -210,6 +211,8 @@ jrx_match_state* jrx_match_state_init(const jrx_regex_t* preg, jrx_offset begin,
 
 void jrx_match_state_done(jrx_match_state* ms)
 {
+    dfa_unregister_match_state(ms->dfa, ms);
+
     if ( ! (ms->dfa->options & JRX_OPTION_NO_CAPTURE ))
     {
         set_for_each(match_accept, ms->accepts, acc)
@@ -242,6 +245,8 @@ static void print_accept_set(set_match_accept* s)
 
 int jrx_match_state_advance(jrx_match_state* ms, jrx_char cp, jrx_assertion assertions)
 {
+    dfa_check_budget(ms->dfa);
+
     jrx_dfa_state* state = dfa_get_state(ms->dfa, ms->state);
 
     if ( ! state )
@@ -20,6 +20,9 @@ static jrx_dfa* _dfa_create()
     dfa->max_capture = -1;
     dfa->max_tag = -1;
     dfa->nfa = 0;
+    dfa->num_states = 0;
+    dfa->max_states = 0;
+    dfa->match_states = 0;
 
     return dfa;
 }
@@ -74,6 +77,8 @@ static jrx_dfa_state_id reserve_dfastate_id(jrx_dfa* dfa, set_dfa_state_elem* ds
     // idiom to use in that case ...
     if ( ! ret )
         kh_del(dfa_state_elem, dfa->hstates, k);
+    else
+        ++dfa_state_sets_cached;
 
     kh_value(dfa->hstates, k) = id;
     return id;
@@ -179,6 +184,11 @@ static set_dfa_state_elem* transition_with(jrx_nfa_context* ctx, jrx_dfa* dfa,
 
 static jrx_dfa_state sentinel; // Value is irrelevant.
 
+uint64_t dfa_states_computed = 0;
+uint64_t dfa_states_cached = 0;
+uint64_t dfa_state_sets_cached = 0;
+uint64_t dfa_flushes = 0;
+
 int dfa_state_compute(jrx_nfa_context* ctx, jrx_dfa* dfa, jrx_dfa_state_id id,
                       set_dfa_state_elem* dstate, int recurse)
 {
@@ -292,6 +302,9 @@ int dfa_state_compute(jrx_nfa_context* ctx, jrx_dfa* dfa, jrx_dfa_state_id id,
     dfastate->accepts = accepts;
 
     vec_dfa_state_set(dfa->states, id, dfastate);
+    ++dfa->num_states;
+    ++dfa_states_computed;
+    ++dfa_states_cached;
     return 1;
 }
 
@@ -302,7 +315,16 @@ jrx_dfa_state* dfa_get_state(jrx_dfa* dfa, jrx_dfa_state_id id)
     if ( state )
         return state;
 
+    if ( id >= vec_dfa_state_size(dfa->states) )
+        // Jammed.
+        return 0;
+
     set_dfa_state_elem* dstate = vec_dfa_state_elem_get(dfa->state_elems, id);
+
+    if ( ! dstate && id == dfa->initial )
+        // Happens after a flush.
+        dstate = dfa->initial_dstate;
+
     assert(dstate);
 
     dfa_state_compute(dfa->nfa->ctx, dfa, id, dstate, 0);
@@ -312,6 +334,125 @@ jrx_dfa_state* dfa_get_state(jrx_dfa* dfa, jrx_dfa_state_id id)
     return state;
 }
 
+void dfa_register_match_state(jrx_dfa* dfa, jrx_match_state* ms)
+{
+    ms->prev_ms = 0;
+    ms->next_ms = dfa->match_states;
+
+    if ( dfa->match_states )
+        dfa->match_states->prev_ms = ms;
+
+    dfa->match_states = ms;
+}
+
+void dfa_unregister_match_state(jrx_dfa* dfa, jrx_match_state* ms)
+{
+    if ( ms->prev_ms )
+        ms->prev_ms->next_ms = ms->next_ms;
+    else if ( dfa->match_states == ms )
+        dfa->match_states = ms->next_ms;
+    else
+        // Not on the list.
+        return;
+
+    if ( ms->next_ms )
+        ms->next_ms->prev_ms = ms->prev_ms;
+
+    ms->prev_ms = 0;
+    ms->next_ms = 0;
+}
+
+// Returns a copy of the set of NFA states that a DFA state has been (or will
+// be) computed from, or null if the ID doesn't refer to a valid state.
+static set_dfa_state_elem* _dfa_state_elems_copy(jrx_dfa* dfa, jrx_dfa_state_id id)
+{
+    if ( id >= vec_dfa_state_elem_size(dfa->state_elems) )
+        return 0;
+
+    set_dfa_state_elem* dstate = vec_dfa_state_elem_get(dfa->state_elems, id);
+
+    if ( ! dstate && id == dfa->initial )
+        dstate = dfa->initial_dstate;
+
+    return dstate ? set_dfa_state_elem_copy(dstate) : 0;
+}
+
+void dfa_flush(jrx_dfa* dfa)
+{
+    if ( ! (dfa->options & JRX_OPTION_LAZY) )
+        // We can't recompute states on demand.
+        return;
+
+    // Like the computed states, we throw away the NFA state sets that
+    // they come from, so that memory usage remains bounded. However, match
+    // states currently using the DFA still need theirs to continue. We save
+    // those and then reinstate them with fresh IDs further below.
+    vec_dfa_state_elem* saved = vec_dfa_state_elem_create(0);
+
+    for ( jrx_match_state* ms = dfa->match_states; ms; ms = ms->next_ms )
+        vec_dfa_state_elem_append(saved, _dfa_state_elems_copy(dfa, ms->state));
+
+    vec_for_each(dfa_state, dfa->states, dstate)
+    {
+        if ( ! dstate )
+            continue;
+
+        assert(dstate != &sentinel);
+        _dfa_state_delete(dstate);
+    }
+
+    // The hash's keys share their elements with these sets, except for the
+    // initial one that we keep.
+    vec_for_each(dfa_state_elem, dfa->state_elems, state_elem)
+    {
+        if ( state_elem )
+            set_dfa_state_elem_delete(state_elem);
+    }
+
+    vec_dfa_state_delete(dfa->states);
+    vec_dfa_state_elem_delete(dfa->state_elems);
+    dfa->states = vec_dfa_state_create(0);
+    dfa->state_elems = vec_dfa_state_elem_create(0);
+
+    dfa_states_cached -= dfa->num_states;
+    dfa_state_sets_cached -= kh_size(dfa->hstates);
+    dfa->num_states = 0;
+    kh_clear(dfa_state_elem, dfa->hstates);
+
+    dfa->initial = reserve_dfastate_id(dfa, dfa->initial_dstate);
+
+    jrx_dfa_state_id idx = 0;
+
+    for ( jrx_match_state* ms = dfa->match_states; ms; ms = ms->next_ms ) {
+        set_dfa_state_elem* elems = vec_dfa_state_elem_get(saved, idx++);
+
+        if ( ! elems ) {
+            // Jammed, and remains so.
+            ms->state = (jrx_dfa_state_id)-1;
+            continue;
+        }
+
+        khiter_t k = kh_get(dfa_state_elem, dfa->hstates, *elems);
+
+        if ( k != kh_end(dfa->hstates) ) {
+            // Another match state is in the same state.
+            ms->state = kh_value(dfa->hstates, k);
+            set_dfa_state_elem_delete(elems);
+        }
+
+        else {
+            ms->state = reserve_dfastate_id(dfa, elems);
+            vec_dfa_state_elem_set(dfa->state_elems, ms->state, elems);
+        }
+    }
+
+    vec_dfa_state_elem_delete(saved);
+    ++dfa_flushes;
+
+    if ( dfa->options & JRX_OPTION_DEBUG )
+        fprintf(stderr, "> flushed DFA states\n");
+}
+
 jrx_dfa* dfa_from_nfa(jrx_nfa* nfa)
 {
     jrx_dfa* dfa = _dfa_create();
@@ -375,6 +516,9 @@ jrx_dfa* dfa_from_nfa(jrx_nfa* nfa)
 
 void dfa_delete(jrx_dfa* dfa)
 {
+    dfa_states_cached -= dfa->num_states;
+    dfa_state_sets_cached -= kh_size(dfa->hstates);
+
     if ( dfa->initial_ops )
         vec_tag_op_delete(dfa->initial_ops);
 
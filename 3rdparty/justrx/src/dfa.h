@@ -89,15 +89,50 @@ typedef struct jrx_dfa {
     hash_dfa_state* hstates;            // Hash of states indexed by set of NFA states.
     jrx_ccl_group* ccls;                // CCLs for the DFA.
     jrx_nfa* nfa;                       // The underlying NFA.
+    uint32_t num_states;                // Number of states currently computed.
+    uint32_t max_states;                // Max. states to keep, computed or reserved, before flushing; 0 for no limit.
+    jrx_match_state* match_states;      // List of match states currently using the DFA.
 } jrx_dfa;
 
 
+// Total number of DFA states computed so far, across all DFAs.
+extern uint64_t dfa_states_computed;
+
+// Number of DFA states currently computed, across all DFAs.
+extern uint64_t dfa_states_cached;
+
+// Number of NFA state sets currently kept for computing DFA states, across all DFAs.
+extern uint64_t dfa_state_sets_cached;
+
+// Total number of times a DFA's computed states have been flushed.
+extern uint64_t dfa_flushes;
+
 extern jrx_dfa* dfa_compile(const char* pattern, int len, jrx_option options, int8_t nmatch,
                             const char** errmsg);
 extern jrx_dfa* dfa_from_nfa(jrx_nfa* nfa);
 extern int dfa_state_compute(jrx_nfa_context* ctx, jrx_dfa* dfa, jrx_dfa_state_id id,
                              set_dfa_state_elem* dstate, int recurse);
 extern jrx_dfa_state* dfa_get_state(jrx_dfa* dfa, jrx_dfa_state_id id);
+extern void dfa_flush(jrx_dfa* dfa);
+
+// Adds a match state to the list of those using a DFA, or removes it again.
+// Removing a match state that isn't on the list is a no-op.
+extern void dfa_register_match_state(jrx_dfa* dfa, jrx_match_state* ms);
+extern void dfa_unregister_match_state(jrx_dfa* dfa, jrx_match_state* ms);
+
+// Flushes the DFA's computed states if it has exceeded its budget. This must
+// be called only at points where no pointers to DFA states are held, as it
+// invalidates them. State IDs get reassigned as well; match states using the
+// DFA are updated accordingly. The states will be recomputed on demand.
+//
+// The budget applies to the NFA state sets kept for the DFA, rather than just
+// to the computed states: computing a state reserves IDs for all of its
+// successors, so the sets can outnumber the computed states many times.
+static inline void dfa_check_budget(jrx_dfa* dfa)
+{
+    if ( dfa->max_states && kh_size(dfa->hstates) > dfa->max_states )
+        dfa_flush(dfa);
+}
 extern void dfa_delete(jrx_dfa* dfa);
 extern void dfa_print(jrx_dfa* dfa, FILE* file);
 
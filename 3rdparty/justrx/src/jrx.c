@@ -368,7 +368,7 @@ int jrx_is_anchored(jrx_regex_t* preg)
 
 int jrx_can_transition(jrx_match_state* ms)
 {
-    jrx_dfa_state* state = vec_dfa_state_get(ms->dfa->states, ms->state);
+    jrx_dfa_state* state = dfa_get_state(ms->dfa, ms->state);
 
     if ( ! state ) {
         if ( ms->dfa->options & JRX_OPTION_DEBUG )
@@ -398,3 +398,29 @@ int jrx_current_accept(jrx_match_state* ms)
     jrx_dfa_state* state = dfa_get_state(ms->dfa, ms->state);
     return state->accepts ? vec_dfa_accept_get(state->accepts, 0).aid : 0;
 }
+
+uint64_t jrx_dfa_states_computed()
+{
+    return dfa_states_computed;
+}
+
+uint64_t jrx_dfa_states_cached()
+{
+    return dfa_states_cached;
+}
+
+uint64_t jrx_dfa_state_sets_cached()
+{
+    return dfa_state_sets_cached;
+}
+
+uint64_t jrx_dfa_flushes()
+{
+    return dfa_flushes;
+}
+
+void jrx_regset_set_max_states(jrx_regex_t* preg, unsigned int max_states)
+{
+    assert(preg->dfa && "regexp not finalized");
+    preg->dfa->max_states = max_states;
+}
@@ -54,6 +54,10 @@ struct jrx_match_state {
 
     // The following are only used with the minimal matcher.
     jrx_accept_id acc;
+
+    // Links into the DFA's list of match states using it (see dfa_flush()).
+    struct jrx_match_state* prev_ms;
+    struct jrx_match_state* next_ms;
 };
 
 struct jrx_regex_t {
@@ -144,8 +148,29 @@ extern int jrx_is_anchored(jrx_regex_t* preg);
 extern int jrx_can_transition(jrx_match_state* ms);
 extern int jrx_current_accept(jrx_match_state* ms);
 
+// Returns the total number of DFA states computed so far, across all regular expressions.
+extern uint64_t jrx_dfa_states_computed();
+
+// Returns the number of DFA states currently kept in memory, across all regular expressions.
+extern uint64_t jrx_dfa_states_cached();
+
+// Returns the number of NFA state sets currently kept in memory for computing
+// DFA states, across all regular expressions.
+extern uint64_t jrx_dfa_state_sets_cached();
+
+// Returns the total number of times a regular expression's DFA states have
+// been flushed because it exceeded its budget.
+extern uint64_t jrx_dfa_flushes();
+
+// Limits the number of DFA states the (lazily computed) DFA of a finalized
+// regular expression keeps in memory. Once exceeded, all states get flushed,
+// along with the NFA state sets they were computed from, and are recomputed on
+// demand. Zero means no limit, which is the default.
+extern void jrx_regset_set_max_states(jrx_regex_t* preg, unsigned int max_states);
+
 extern jrx_match_state* jrx_match_state_init(const jrx_regex_t* preg, jrx_offset begin, jrx_match_state* ms);
 extern void jrx_match_state_copy(const jrx_match_state* from, jrx_match_state* to); // supports only min-matcher state
+extern void jrx_match_state_move(jrx_match_state* from, jrx_match_state* to); // "from" must not be used anymore afterwards
 extern void jrx_match_state_done(jrx_match_state* ms);
 
 #endif
@@ -0,0 +1,126 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+//
+// A small harness for microbenchmarks. Each benchmark is a function
+// executing its workload repeatedly while `State::keepRunning()` returns
+// true. The harness calibrates the number of iterations so that each
+// benchmark runs for a minimum amount of time, and then reports the time
+// per iteration along with any throughput the benchmark has recorded.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace spicy::benchmark {
+
+/** State passed to a running benchmark. */
+class State {
+public:
+    explicit State(uint64_t iterations) : _iterations(iterations), _remaining(iterations) {}
+
+    /**
+     * Returns true as long as the benchmark should execute another
+     * iteration. Time measurement starts with the first call.
+     */
+    bool keepRunning() {
+        if ( ! _started ) {
+            _started = true;
+            _start = Clock::now();
+        }
+
+        if ( _remaining > 0 ) {
+            --_remaining;
+            return true;
+        }
+
+        _stop();
+        return false;
+    }
+
+    /** Excludes time from measurement until `resumeTiming()` is called. */
+    void pauseTiming() { _paused_at = Clock::now(); }
+
+    /** Counterpart to `pauseTiming()`. */
+    void resumeTiming() { _paused += (Clock::now() - _paused_at); }
+
+    /** Records the number of bytes processed per iteration. */
+    void setBytesPerIteration(uint64_t n) { _bytes = n; }
+
+    /** Records the number of items (e.g., messages) processed per iteration. */
+    void setItemsPerIteration(uint64_t n) { _items = n; }
+
+    /** Marks the benchmark as failed, with a message why. */
+    void fail(std::string msg) { _error = std::move(msg); }
+
+    uint64_t iterations() const { return _iterations; }
+    uint64_t bytesPerIteration() const { return _bytes; }
+    uint64_t itemsPerIteration() const { return _items; }
+    const std::string& error() const { return _error; }
+
+    /** Returns the total time measured, in nanoseconds. */
+    uint64_t elapsed() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(_elapsed).count(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void _stop() {
+        if ( ! _stopped ) {
+            _elapsed = (Clock::now() - _start) - _paused;
+            _stopped = true;
+        }
+    }
+
+    uint64_t _iterations;
+    uint64_t _remaining;
+    uint64_t _bytes = 0;
+    uint64_t _items = 0;
+    std::string _error;
+    bool _started = false;
+    bool _stopped = false;
+    Clock::time_point _start;
+    Clock::time_point _paused_at;
+    Clock::duration _paused{};
+    Clock::duration _elapsed{};
+};
+
+/** Type of a function implementing a benchmark. */
+using Function = std::function<void(State&)>;
+
+/** A registered benchmark. */
+struct Benchmark {
+    std::string name;
+    Function function;
+};
+
+/** Returns all benchmarks registered so far. */
+extern std::vector<Benchmark>& benchmarks();
+
+/** Helper registering a benchmark at startup through a global instance. */
+struct Register {
+    Register(std::string name, Function f) { benchmarks().push_back({std::move(name), std::move(f)}); }
+};
+
+/**
+ * Prevents the compiler from optimizing away a computation whose result
+ * isn't used otherwise.
+ */
+template<typename T>
+inline void doNotOptimize(const T& x) {
+    asm volatile("" : : "g"(&x) : "memory");
+}
+
+} // namespace spicy::benchmark
+
+#define SPICY_BENCHMARK_CONCAT2(a, b) a##b
+#define SPICY_BENCHMARK_CONCAT(a, b) SPICY_BENCHMARK_CONCAT2(a, b)
+
+/** Defines and registers a benchmark with the given name. */
+#define SPICY_BENCHMARK(name)                                                                                          \
+    static void SPICY_BENCHMARK_CONCAT(_benchmark_, __LINE__)(::spicy::benchmark::State & state);                     \
+    static ::spicy::benchmark::Register SPICY_BENCHMARK_CONCAT(_register_, __LINE__)(                                 \
+        name, SPICY_BENCHMARK_CONCAT(_benchmark_, __LINE__));                                                          \
+    static void SPICY_BENCHMARK_CONCAT(_benchmark_, __LINE__)(::spicy::benchmark::State & state)
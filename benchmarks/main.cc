@@ -0,0 +1,199 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <regex>
+
+#include <hilti/json.h>
+
+#include <hilti/rt/libhilti.h>
+#include <spicy/rt/libspicy.h>
+
+#include "benchmark.h"
+
+using namespace spicy::benchmark;
+
+std::vector<Benchmark>& spicy::benchmark::benchmarks() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+static struct option long_options[] = {{"filter", required_argument, nullptr, 'f'},
+                                       {"help", no_argument, nullptr, 'h'},
+                                       {"json", required_argument, nullptr, 'j'},
+                                       {"list", no_argument, nullptr, 'l'},
+                                       {"min-time", required_argument, nullptr, 't'},
+                                       {nullptr, 0, nullptr, 0}};
+
+static void usage() {
+    std::cerr << "Usage: spicy-benchmarks [options]\n"
+                 "\n"
+                 "Options:\n"
+                 "\n"
+                 "  -f | --filter <regexp>    Run only benchmarks with names matching <regexp>.\n"
+                 "  -j | --json <file>        Write results in JSON format to <file> ('-' for stdout).\n"
+                 "  -l | --list               List available benchmarks and exit.\n"
+                 "  -t | --min-time <secs>    Minimum time to run each benchmark for [default: 0.5].\n"
+                 "\n";
+}
+
+struct Measurement {
+    std::string name;
+    uint64_t iterations;
+    double time;             // nanoseconds per iteration
+    double bytes_per_second; // zero if not recorded
+    double items_per_second; // zero if not recorded
+    std::string error;
+};
+
+static Measurement run(const Benchmark& b, double min_time) {
+    const uint64_t min_ns = min_time * 1e9;
+    const uint64_t max_iterations = 1000000000;
+    uint64_t n = 1;
+
+    while ( true ) {
+        State state(n);
+        b.function(state);
+
+        if ( ! state.error().empty() )
+            return Measurement{b.name, 0, 0, 0, 0, state.error()};
+
+        auto elapsed = std::max(state.elapsed(), static_cast<uint64_t>(1));
+
+        if ( elapsed >= min_ns || n >= max_iterations ) {
+            auto seconds = static_cast<double>(elapsed) / 1e9;
+            auto bytes = state.bytesPerIteration() * n / seconds;
+            auto items = state.itemsPerIteration() * n / seconds;
+            return Measurement{b.name, n, static_cast<double>(elapsed) / n, bytes, items, ""};
+        }
+
+        // Aim a bit beyond the minimum time, but don't grow too quickly
+        // based on a possibly noisy first measurement.
+        auto estimate = static_cast<uint64_t>(n * 1.4 * min_ns / elapsed);
+        n = std::min(std::max(estimate, n + 1), std::min(n * 10, max_iterations));
+    }
+}
+
+static void reportText(const Measurement& m) {
+    if ( ! m.error.empty() ) {
+        std::cout << hilti::rt::fmt("%-40s ERROR: %s", m.name, m.error) << std::endl;
+        return;
+    }
+
+    auto line = hilti::rt::fmt("%-40s %12" PRIu64 " %14.1f ns", m.name, m.iterations, m.time);
+
+    if ( m.bytes_per_second > 0 )
+        line += hilti::rt::fmt(" %10.1f MB/s", m.bytes_per_second / 1e6);
+
+    if ( m.items_per_second > 0 )
+        line += hilti::rt::fmt(" %12.1f items/s", m.items_per_second);
+
+    std::cout << line << std::endl;
+}
+
+// We follow the JSON layout of Google's benchmark library so that existing
+// tooling for comparing results across runs can be used.
+static void reportJSON(const std::vector<Measurement>& results, std::ostream& out) {
+    auto benchmarks = nlohmann::json::array();
+
+    for ( const auto& m : results ) {
+        nlohmann::json b = {{"name", m.name}, {"run_type", "iteration"}};
+
+        if ( ! m.error.empty() ) {
+            b["error_occurred"] = true;
+            b["error_message"] = m.error;
+        }
+        else {
+            b["iterations"] = m.iterations;
+            b["real_time"] = m.time;
+            b["cpu_time"] = m.time;
+            b["time_unit"] = "ns";
+
+            if ( m.bytes_per_second > 0 )
+                b["bytes_per_second"] = m.bytes_per_second;
+
+            if ( m.items_per_second > 0 )
+                b["items_per_second"] = m.items_per_second;
+        }
+
+        benchmarks.push_back(std::move(b));
+    }
+
+    char date[64];
+    auto now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+
+    nlohmann::json j = {{"context", {{"date", date}, {"library_version", hilti::rt::version()}}},
+                        {"benchmarks", benchmarks}};
+
+    out << j.dump(4) << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::optional<std::regex> filter;
+    std::optional<std::string> json;
+    double min_time = 0.5;
+    bool list = false;
+
+    while ( true ) {
+        int c = getopt_long(argc, argv, "f:hj:lt:", long_options, nullptr);
+
+        if ( c < 0 )
+            break;
+
+        switch ( c ) {
+            case 'f': filter = std::regex(optarg); break;
+            case 'j': json = optarg; break;
+            case 'l': list = true; break;
+            case 't': min_time = atof(optarg); break; // NOLINT
+            case 'h': usage(); exit(0);
+            default: usage(); exit(1);
+        }
+    }
+
+    auto selected = benchmarks();
+    std::sort(selected.begin(), selected.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+
+    if ( filter )
+        selected.erase(std::remove_if(selected.begin(), selected.end(),
+                                      [&](const auto& b) { return ! std::regex_search(b.name, *filter); }),
+                       selected.end());
+
+    if ( list ) {
+        for ( const auto& b : selected )
+            std::cout << b.name << std::endl;
+
+        return 0;
+    }
+
+    hilti::rt::init();
+    spicy::rt::init();
+
+    std::vector<Measurement> results;
+    bool failed = false;
+
+    for ( const auto& b : selected ) {
+        auto m = run(b, min_time);
+        reportText(m);
+        failed = failed || ! m.error.empty();
+        results.push_back(std::move(m));
+    }
+
+    spicy::rt::done();
+    hilti::rt::done();
+
+    if ( json ) {
+        if ( *json == "-" )
+            reportJSON(results, std::cout);
+        else {
+            std::ofstream out(*json);
+            reportJSON(results, out);
+        }
+    }
+
+    return failed ? 1 : 0;
+}
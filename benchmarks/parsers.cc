@@ -0,0 +1,243 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+//
+// End-to-end benchmarks running generated Spicy parsers on payload
+// extracted from the traces coming with the test suite.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <hilti/rt/libhilti.h>
+#include <spicy/rt/libspicy.h>
+
+#include "benchmark.h"
+
+using namespace spicy::benchmark;
+
+namespace {
+
+/** Payload of a single UDP packet or TCP segment. */
+struct Packet {
+    uint16_t src_port;
+    uint16_t dst_port;
+    std::string payload;
+};
+
+uint16_t get16(const unsigned char* p) { return (p[0] << 8U) | p[1]; }
+
+uint32_t get32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24U) | (p[1] << 16U) | (p[2] << 8U) | p[3];
+}
+
+/**
+ * Minimal reader for libpcap traces with Ethernet link layer, extracting
+ * the payload of all IPv4/IPv6 UDP and TCP packets. Fails the benchmark if
+ * the trace can't be read.
+ */
+std::vector<Packet> readTrace(State& state, const std::string& name, uint8_t proto) {
+    auto path = std::string(SPICY_BENCHMARK_TRACES) + "/" + name;
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if ( data.size() < 24 ) {
+        state.fail(hilti::rt::fmt("cannot read trace %s", path));
+        return {};
+    }
+
+    uint32_t magic;
+    memcpy(&magic, data.data(), sizeof(magic));
+
+    if ( magic != 0xa1b2c3d4 ) {
+        state.fail(hilti::rt::fmt("%s: unsupported trace format", path));
+        return {};
+    }
+
+    std::vector<Packet> packets;
+    std::map<std::pair<uint16_t, uint16_t>, uint32_t> next_seq; // per TCP direction
+
+    for ( size_t offset = 24; offset + 16 <= data.size(); ) {
+        uint32_t caplen;
+        memcpy(&caplen, data.data() + offset + 8, sizeof(caplen));
+        offset += 16;
+
+        if ( offset + caplen > data.size() )
+            break;
+
+        auto p = reinterpret_cast<const unsigned char*>(data.data() + offset);
+        auto end = p + caplen;
+        offset += caplen;
+
+        if ( caplen < 14 )
+            continue;
+
+        auto ethertype = get16(p + 12);
+        p += 14;
+
+        uint8_t next;
+        const unsigned char* ip_end;
+
+        if ( ethertype == 0x0800 && p + 20 <= end ) {
+            next = p[9];
+            ip_end = std::min(end, p + get16(p + 2));
+            p += (p[0] & 0x0fU) * 4;
+        }
+        else if ( ethertype == 0x86dd && p + 40 <= end ) {
+            next = p[6];
+            ip_end = std::min(end, p + 40 + get16(p + 4));
+            p += 40;
+        }
+        else
+            continue;
+
+        if ( next != proto )
+            continue;
+
+        size_t hdr_len;
+
+        if ( proto == 17 )
+            hdr_len = 8;
+        else if ( p + 13 <= ip_end )
+            hdr_len = (p[12] >> 4U) * 4;
+        else
+            continue;
+
+        if ( p + hdr_len > ip_end )
+            continue;
+
+        auto payload = std::string(reinterpret_cast<const char*>(p + hdr_len), ip_end - p - hdr_len);
+        packets.push_back(Packet{get16(p), get16(p + 2), std::move(payload)});
+
+        if ( proto == 6 ) {
+            // Drop retransmissions, we just want the byte stream.
+            auto key = std::make_pair(get16(p), get16(p + 2));
+            auto seq = get32(p + 4);
+            auto syn = (p[13] & 0x02U) ? 1 : 0;
+
+            if ( auto i = next_seq.find(key); i != next_seq.end() && seq != i->second )
+                packets.pop_back();
+            else
+                next_seq[key] = seq + syn + packets.back().payload.size();
+        }
+    }
+
+    return packets;
+}
+
+/**
+ * Concatenates the TCP payload of one direction of a connection, either
+ * sent from or sent to the given server port.
+ */
+std::string reassemble(const std::vector<Packet>& packets, uint16_t port, bool from_server) {
+    std::string data;
+
+    for ( const auto& p : packets ) {
+        if ( (from_server ? p.src_port : p.dst_port) == port )
+            data += p.payload;
+    }
+
+    return data;
+}
+
+/** Returns the parser of the given name, failing the benchmark if it doesn't exist. */
+const spicy::rt::Parser* findParser(State& state, const std::string& name) {
+    for ( const auto& p : spicy::rt::parsers() ) {
+        if ( p->name == name )
+            return p;
+    }
+
+    state.fail(hilti::rt::fmt("parser %s not available", name));
+    return nullptr;
+}
+
+/** Runs a parser once on a complete message. Returns false on parse errors. */
+bool parse(State& state, const spicy::rt::Parser* parser, const std::string& data) {
+    hilti::rt::ValueReference<hilti::rt::Stream> input;
+    input->append(hilti::rt::Bytes(std::string(data)));
+    input->freeze();
+
+    try {
+        auto r = parser->parse1(input, {});
+
+        if ( ! r ) {
+            state.fail(hilti::rt::fmt("%s: parser did not finish on complete input", parser->name));
+            return false;
+        }
+
+        doNotOptimize(r);
+        return true;
+    } catch ( const hilti::rt::Exception& e ) {
+        state.fail(hilti::rt::fmt("%s: %s", parser->name, e.what()));
+        return false;
+    }
+}
+
+/** Benchmarks parsing each of a set of messages in turn. */
+void benchmarkMessages(State& state, const std::string& parser_name, const std::vector<std::string>& messages) {
+    auto parser = findParser(state, parser_name);
+    if ( ! parser )
+        return;
+
+    if ( messages.empty() ) {
+        state.fail("no input");
+        return;
+    }
+
+    uint64_t bytes = 0;
+    for ( const auto& m : messages )
+        bytes += m.size();
+
+    while ( state.keepRunning() ) {
+        for ( const auto& m : messages ) {
+            if ( ! parse(state, parser, m) )
+                return;
+        }
+    }
+
+    state.setBytesPerIteration(bytes);
+    state.setItemsPerIteration(messages.size());
+}
+
+std::vector<std::string> payloads(const std::vector<Packet>& packets) {
+    std::vector<std::string> x;
+
+    for ( const auto& p : packets ) {
+        if ( ! p.payload.empty() )
+            x.push_back(p.payload);
+    }
+
+    return x;
+}
+
+} // namespace
+
+SPICY_BENCHMARK("parser/dns") {
+    // One message per UDP packet.
+    auto packets = readTrace(state, "dns53.pcap", 17);
+    benchmarkMessages(state, "DNS::Message", payloads(packets));
+}
+
+SPICY_BENCHMARK("parser/tftp") {
+    // One message per UDP packet.
+    auto packets = readTrace(state, "tftp_rrq.pcap", 17);
+    benchmarkMessages(state, "TFTP::Packet", payloads(packets));
+}
+
+SPICY_BENCHMARK("parser/http/requests") {
+    auto packets = readTrace(state, "http-post.trace", 6);
+    benchmarkMessages(state, "HTTP::Requests", {reassemble(packets, 80, false)});
+}
+
+SPICY_BENCHMARK("parser/http/replies") {
+    auto packets = readTrace(state, "http-post.trace", 6);
+    benchmarkMessages(state, "HTTP::Replies", {reassemble(packets, 80, true)});
+}
+
+SPICY_BENCHMARK("parser/ssh") {
+    // Server side of the connection, starting with its banner.
+    auto packets = readTrace(state, "ssh-single-conn.trace", 6);
+    benchmarkMessages(state, "SSH::Banner", {reassemble(packets, 22, true)});
+}
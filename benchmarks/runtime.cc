@@ -0,0 +1,541 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+//
+// Microbenchmarks for individual pieces of the HILTI and Spicy runtime
+// libraries.
+
+#include <string>
+#include <vector>
+
+#include <hilti/rt/libhilti.h>
+#include <spicy/rt/libspicy.h>
+
+#include "benchmark.h"
+
+using namespace hilti::rt;
+using namespace spicy::benchmark;
+
+// Returns `n` bytes of pseudo-random printable data that contains neither
+// the byte 'X' nor the string "needle".
+static std::string makeData(size_t n) {
+    std::string s;
+    s.reserve(n);
+
+    uint32_t x = 42;
+    for ( size_t i = 0; i < n; i++ ) {
+        x = x * 1103515245 + 12345;
+        s.push_back(static_cast<char>('a' + (x >> 16U) % 20)); // a-t
+    }
+
+    return s;
+}
+
+// Returns a stream containing `n` chunks of `chunk_size` bytes each, with
+// `suffix` appended as a final chunk.
+static Stream makeStream(size_t n, size_t chunk_size, const std::string& suffix = "") {
+    Stream s;
+    auto chunk = makeData(chunk_size);
+
+    for ( size_t i = 0; i < n; i++ )
+        s.append(Bytes(std::string(chunk)));
+
+    if ( ! suffix.empty() )
+        s.append(Bytes(std::string(suffix)));
+
+    return s;
+}
+
+/// Streams
+
+SPICY_BENCHMARK("stream/append/small") {
+    const auto data = Bytes(makeData(16));
+
+    while ( state.keepRunning() ) {
+        Stream s;
+        for ( int i = 0; i < 64; i++ )
+            s.append(data);
+
+        doNotOptimize(s);
+    }
+
+    state.setBytesPerIteration(64 * 16);
+}
+
+SPICY_BENCHMARK("stream/append/large") {
+    const auto data = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        Stream s;
+        for ( int i = 0; i < 64; i++ )
+            s.append(data);
+
+        doNotOptimize(s);
+    }
+
+    state.setBytesPerIteration(64 * 4096);
+}
+
+SPICY_BENCHMARK("stream/append-trim") {
+    // Steady state of incremental parsing: new data comes in, old data gets
+    // trimmed off once consumed.
+    const auto data = Bytes(makeData(1024));
+    Stream s;
+
+    while ( state.keepRunning() ) {
+        s.append(data);
+        s.trim(s.end());
+    }
+
+    state.setBytesPerIteration(1024);
+}
+
+SPICY_BENCHMARK("stream/find/byte") {
+    const auto s = makeStream(64, 1024, "X");
+    const auto v = s.view();
+
+    while ( state.keepRunning() ) {
+        auto i = v.find('X');
+        doNotOptimize(i);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+SPICY_BENCHMARK("stream/find/bytes") {
+    const auto s = makeStream(64, 1024, "needle");
+    const auto v = s.view();
+    const auto needle = Bytes("needle");
+
+    while ( state.keepRunning() ) {
+        auto i = v.find(needle);
+        doNotOptimize(i);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+SPICY_BENCHMARK("stream/view/data") {
+    const auto s = makeStream(64, 1024);
+    const auto v = s.view();
+
+    while ( state.keepRunning() ) {
+        auto d = v.data();
+        doNotOptimize(d);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+SPICY_BENCHMARK("stream/view/size") {
+    const auto s = makeStream(64, 1024);
+    const auto v = s.view().sub(s.at(10), s.at(60 * 1024));
+
+    while ( state.keepRunning() ) {
+        auto n = v.size();
+        doNotOptimize(n);
+    }
+}
+
+/// Bytes
+
+SPICY_BENCHMARK("bytes/find") {
+    const auto data = Bytes(makeData(64 * 1024) + "needle");
+    const auto needle = Bytes("needle");
+
+    while ( state.keepRunning() ) {
+        auto i = data.find(needle);
+        doNotOptimize(i);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("bytes/sub") {
+    const auto data = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        auto b = data.sub(100, 1100);
+        doNotOptimize(b);
+    }
+
+    state.setBytesPerIteration(1000);
+}
+
+SPICY_BENCHMARK("bytes/compare") {
+    const auto a = Bytes(makeData(4096));
+    const auto b = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        auto x = (a == b);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(4096);
+}
+
+SPICY_BENCHMARK("bytes/upper") {
+    const auto data = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        auto b = data.upper(bytes::Charset::ASCII);
+        doNotOptimize(b);
+    }
+
+    state.setBytesPerIteration(4096);
+}
+
+SPICY_BENCHMARK("bytes/decode/ascii") {
+    const auto data = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        auto x = data.decode(bytes::Charset::ASCII);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(4096);
+}
+
+SPICY_BENCHMARK("string/lower") {
+    const auto data = "Content-Type: " + makeData(4096);
+
+    while ( state.keepRunning() ) {
+        auto x = string::lower(data);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("bytes/to-uint") {
+    const auto data = Bytes("1234567890");
+
+    while ( state.keepRunning() ) {
+        auto x = data.toUInt();
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+/// Vectors
+
+SPICY_BENCHMARK("vector/small") {
+    while ( state.keepRunning() ) {
+        Vector<uint8_t> v;
+        v.reserve(4);
+
+        for ( uint8_t i = 0; i < 4; i++ )
+            v.push_back(i);
+
+        doNotOptimize(v);
+    }
+
+    state.setItemsPerIteration(4);
+}
+
+SPICY_BENCHMARK("vector/iterate/safe") {
+    Vector<uint64_t> v;
+    for ( auto i = 0; i < 1024; i++ )
+        v.push_back(1);
+
+    while ( state.keepRunning() ) {
+        uint64_t sum = 0;
+        for ( auto x : v )
+            sum += x;
+
+        doNotOptimize(sum);
+    }
+
+    state.setItemsPerIteration(1024);
+}
+
+SPICY_BENCHMARK("vector/iterate/unsafe") {
+    Vector<uint64_t> v;
+    for ( auto i = 0; i < 1024; i++ )
+        v.push_back(1);
+
+    while ( state.keepRunning() ) {
+        uint64_t sum = 0;
+        for ( auto x : unsafe_range(v) )
+            sum += x;
+
+        doNotOptimize(sum);
+    }
+
+    state.setItemsPerIteration(1024);
+}
+
+/// Integer unpacking
+
+SPICY_BENCHMARK("unpack/uint16/big") {
+    const auto data = Bytes(makeData(2));
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint16_t>(data, ByteOrder::Big);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("unpack/uint32/big") {
+    const auto data = Bytes(makeData(4));
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint32_t>(data, ByteOrder::Big);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("unpack/uint64/little") {
+    const auto data = Bytes(makeData(8));
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint64_t>(data, ByteOrder::Little);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("unpack/uint32/big/static") {
+    const auto data = Bytes(makeData(4));
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint32_t, ByteOrder::Big>(data);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("unpack/uint32/stream") {
+    const auto s = makeStream(1, 64);
+    const auto v = s.view();
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint32_t>(v, ByteOrder::Network);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("unpack/uint32/stream/static") {
+    const auto s = makeStream(1, 64);
+    const auto v = s.view();
+
+    while ( state.keepRunning() ) {
+        auto x = integer::unpack<uint32_t, ByteOrder::Network>(v);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+/// Regular expressions
+
+SPICY_BENCHMARK("regexp/find/anchored") {
+    const auto re = RegExp("^[a-t]+ needle");
+    const auto data = Bytes(makeData(4096) + " needle");
+
+    while ( state.keepRunning() ) {
+        auto x = re.find(data);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("regexp/find/unanchored") {
+    const auto re = RegExp("needle", regexp::Flags({.no_sub = 1}));
+    const auto data = Bytes(makeData(4096) + "needle");
+
+    while ( state.keepRunning() ) {
+        auto x = re.find(data);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("regexp/find/no-match") {
+    // No literal prefix to skip ahead to, and a partial match at every offset.
+    const auto re = RegExp("[a-t]+X", regexp::Flags({.no_sub = 1}));
+    const auto data = Bytes(makeData(4096));
+
+    while ( state.keepRunning() ) {
+        auto x = re.find(data);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("regexp/find-groups") {
+    const auto re = RegExp("([a-t]+)=([0-9]+)");
+    const auto data = Bytes(makeData(64) + "=12345");
+
+    while ( state.keepRunning() ) {
+        auto x = re.findGroups(data);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("regexp/token-matcher") {
+    const auto re = RegExp("[a-t]+X", regexp::Flags({.no_sub = 1}));
+    const auto data = Bytes(makeData(1024) + "X");
+
+    while ( state.keepRunning() ) {
+        auto ms = re.tokenMatcher();
+        auto x = ms.advance(data, true);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(data.size());
+}
+
+SPICY_BENCHMARK("regexp/token-matcher/short") {
+    const auto re = RegExp("[a-t]+X", regexp::Flags({.no_sub = 1}));
+    const auto data = Bytes("abcX");
+
+    while ( state.keepRunning() ) {
+        auto ms = re.tokenMatcher();
+        auto x = ms.advance(data, true);
+        doNotOptimize(x);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+/// Literal sets
+
+SPICY_BENCHMARK("literal-set/find") {
+    // Dozens of markers, none of which occurs in the data.
+    Vector<Bytes> literals;
+    for ( int i = 0; i < 32; i++ )
+        literals.emplace_back(Bytes(fmt("marker-%d", i)));
+
+    const auto set = LiteralSet(literals);
+    const auto s = makeStream(64, 1024);
+    const auto v = s.view();
+
+    while ( state.keepRunning() ) {
+        auto x = set.find(v);
+        doNotOptimize(x);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+/// Fibers
+
+SPICY_BENCHMARK("fiber/execute") {
+    while ( state.keepRunning() ) {
+        auto r = fiber::execute([](resumable::Handle* /* r */) { return 42; });
+        doNotOptimize(r);
+    }
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("fiber/switch") {
+    // Each iteration yields and resumes once, i.e., switches back and forth.
+    const uint64_t n = state.iterations();
+
+    auto r = fiber::execute([n](resumable::Handle* r) {
+        for ( uint64_t i = 0; i < n; i++ )
+            r->yield();
+
+        return true;
+    });
+
+    while ( state.keepRunning() ) {
+        if ( ! r )
+            r.resume();
+    }
+
+    if ( ! r )
+        state.fail("fiber did not finish");
+
+    state.setItemsPerIteration(1);
+}
+
+SPICY_BENCHMARK("fiber/switch/interleaved") {
+    // Round-robin across many suspended fibers, like parsers for concurrent
+    // connections. Each iteration resumes one fiber.
+    const uint64_t n = state.iterations();
+    std::vector<Resumable> rs;
+
+    for ( int i = 0; i < 100; i++ )
+        rs.push_back(fiber::execute([n](resumable::Handle* r) {
+            for ( uint64_t i = 0; i < n; i++ )
+                r->yield();
+
+            return true;
+        }));
+
+    uint64_t i = 0;
+
+    while ( state.keepRunning() )
+        rs[i++ % rs.size()].resume();
+
+    for ( auto& r : rs )
+        r.abort();
+
+    state.setItemsPerIteration(1);
+}
+
+/// Sinks
+
+SPICY_BENCHMARK("sink/in-order") {
+    const auto data = Bytes(makeData(1024));
+
+    while ( state.keepRunning() ) {
+        spicy::rt::Sink sink;
+        for ( uint64_t i = 0; i < 64; i++ )
+            sink.write(data, i * 1024);
+
+        doNotOptimize(sink);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+SPICY_BENCHMARK("sink/out-of-order") {
+    // Writes every pair of chunks in reverse order, forcing the reassembler
+    // to buffer every other chunk.
+    const auto data = Bytes(makeData(1024));
+
+    while ( state.keepRunning() ) {
+        spicy::rt::Sink sink;
+        for ( uint64_t i = 0; i < 64; i += 2 ) {
+            sink.write(data, (i + 1) * 1024);
+            sink.write(data, i * 1024);
+        }
+
+        doNotOptimize(sink);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
+
+SPICY_BENCHMARK("sink/overlapping") {
+    // Writes chunks overlapping by half their size.
+    const auto data = Bytes(makeData(1024));
+
+    while ( state.keepRunning() ) {
+        spicy::rt::Sink sink;
+        sink.write(data, 0);
+
+        for ( uint64_t i = 2; i < 128; i++ )
+            sink.write(data, i * 512);
+
+        doNotOptimize(sink);
+    }
+
+    state.setBytesPerIteration(64 * 1024);
+}
@@ -3,8 +3,10 @@
 #pragma once
 
 #include <list>
+#include <optional>
 #include <utility>
 
+#include <hilti/ast/id.h>
 #include <hilti/ast/node.h>
 #include <hilti/ast/type.h>
 #include <hilti/base/type_erase.h>
@@ -43,6 +45,18 @@ inline bool operator!=(const Expression& e1, const Expression& e2) { return ! (e
 using Expression = expression::detail::Expression;
 using expression::detail::to_node;
 
+namespace expression {
+
+/**
+ * Determines if an expression refers to an enum label that's known at
+ * compile time, looking through constants, coercions, and wrappers.
+ *
+ * @return the label's local ID if so, or an unset optional if not
+ */
+extern std::optional<ID> constantEnumLabel(const Expression& e);
+
+} // namespace expression
+
 /** Constructs an AST node from any class implementing the `Expression` interface. */
 template<typename T, typename std::enable_if_t<std::is_base_of<trait::isExpression, T>::value>* = nullptr>
 inline Node to_node(T t) {
@@ -34,6 +34,7 @@ struct Options {
     std::string cxx_namespace_intern = "__hlt"; /**< CXX namespace for generated internal C++ code */
     std::vector<std::filesystem::path>
         cxx_include_paths; /**< additional C++ directories to search for #include files. */
+    bool enable_profiling = false; /**< if true, instrument generated code for the runtime profiler */
 
     /**
      * Parses a comma-separated list of tokens indicating which additional
@@ -16,9 +16,26 @@ struct Configuration {
     /** Stack size for fibers. */
     size_t fiber_stack_size = 100 * 1024 * 1024; // This is generous.
 
+    /**
+     * Run fibers on a single stack shared between them, copying a fiber's
+     * part of it out while others execute. This keeps the memory that a
+     * suspended fiber occupies down to the state it actually has on its
+     * stack. If disabled, each fiber gets an individual stack. Ignored when
+     * compiling with a sanitizer.
+     */
+    bool fiber_shared_stack = false;
+
     /** Maximum size of pool of recycalable fibers. */
     size_t fiber_max_pool_size = 1000;
 
+    /**
+     * Maximum number of DFA states a regular expression keeps in memory.
+     * States get computed lazily as matching encounters them; once a
+     * regular expression exceeds this limit, all its states are discarded
+     * and then recomputed on demand. Zero means no limit.
+     */
+    unsigned int regexp_max_dfa_states = 10000;
+
     /** File where debug output is to be sent. Default is stderr. */
     std::optional<std::filesystem::path> debug_out;
 
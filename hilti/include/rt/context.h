@@ -56,13 +56,6 @@ struct Context {
 
     /** Current indent level for debug messages. */
     uint64_t debug_indent{};
-
-    /**
-     * If non-null, a string describing the most recent source code position.
-     *
-     * Use `debug::setLocation()` to set the current source code location.
-     */
-    const char* source_location{};
 };
 
 namespace context {
@@ -40,11 +40,22 @@ using Handle = detail::Fiber;
 
 namespace detail {
 
+struct SharedStack;
+
 /**
  * A fiber implements a co-routine that can at any time yield control back to
  * the caller, to be resumed later. This is the internal class implementing
  * the main functionalty. It's used by `Resumable`, which provides the
  * external interface.
+ *
+ * By default, each fiber gets an individual stack. If
+ * `Configuration::fiber_shared_stack` is enabled, fibers started from
+ * outside of any other fiber execute on a single stack that they all share
+ * instead. When switching to a different fiber, the part of the shared
+ * stack that a suspended fiber is using gets copied out, and later back in
+ * once it resumes. That way a suspended fiber keeps only its live state,
+ * rather than holding on to a full stack of its own. Fibers started from
+ * inside another fiber always get individual stacks.
  */
 class Fiber {
 public:
@@ -58,6 +69,7 @@ public:
 
     void init(std::function<std::any(resumable::Handle*)> f) {
         _state = State::Init;
+        _yields = 0;
         _result = {};
         _exception = nullptr;
         _function = std::move(f);
@@ -71,6 +83,15 @@ public:
     auto&& result() { return std::move(_result); }
     std::exception_ptr exception() const { return _exception; }
 
+    /** Returns the number of times the fiber's current function has yielded so far. */
+    uint64_t yields() const { return _yields; }
+
+    /**
+     * Returns the total time, in nanoseconds, the fiber has spent suspended
+     * so far. This is tracked only while the profiler is active.
+     */
+    uint64_t suspendedTime() const { return _suspended; }
+
     static std::unique_ptr<Fiber> create();
     static void destroy(std::unique_ptr<Fiber> f);
     static void reset();
@@ -80,13 +101,44 @@ public:
         uint64_t current;
         uint64_t cached;
         uint64_t max;
+        uint64_t stack_size; // size of the stack allocated for each fiber not running on the shared stack
+        uint64_t stack_bytes; // total bytes currently allocated for stacks, including saved copies of the shared stack
+        uint64_t stack_copies; // number of times a fiber's stack was copied out of, or back into, the shared stack
+        uint64_t switches;   // number of times execution switched into a fiber
+        uint64_t functions;  // number of functions that finished executing inside a fiber
+        uint64_t yields;     // total number of yields across all functions
+        uint64_t max_yields; // largest number of yields by a single function
+        uint64_t direct;     // number of functions executed directly, without switching to a fiber
     };
 
     static Statistics statistics();
 
 private:
     friend void ::_Trampoline(unsigned int y, unsigned int x);
-    enum class State { Init, Running, Aborting, Yielded, Idle, Finished };
+    friend class DirectExecution;
+    friend struct SharedStack;
+    enum class State { Init, Running, Aborting, Yielded, Idle };
+
+    /**
+     * Transfers control to a different context, making sure first that the
+     * shared stack holds the frames that the destination needs.
+     *
+     * @param owner fiber whose frames need to be on the shared stack for the
+     * destination to execute, or null if it doesn't depend on the shared
+     * stack
+     *
+     * @param target location to continue at; if null, *start* gets started
+     * fresh instead
+     *
+     * @param start fiber to start if *target* is null
+     */
+    [[noreturn]] static void _switchTo(Fiber* owner, jmp_buf* target, Fiber* start = nullptr);
+
+    /**
+     * Records the fiber whose frames need to be on the shared stack while
+     * we execute, keeping track of whether it's still running the same job.
+     */
+    void _anchorTo(Fiber* anchor);
 
     /** Code to run just before we switch to a fiber. */
     void _startSwitchFiber(const char* tag, const void* stack_bottom = nullptr, size_t stack_size = 0);
@@ -98,10 +150,29 @@ private:
     std::optional<std::function<std::any(resumable::Handle*)>> _function;
     std::optional<std::any> _result;
     std::exception_ptr _exception;
+    uint64_t _yields = 0;
+    uint64_t _suspended = 0;
+
+    bool _shared = false;     // true if running on the shared stack
+    Fiber* _caller = nullptr; // fiber that last started or resumed us, if any
+    Fiber* _anchor = nullptr; // fiber whose frames need to be on the shared stack while we execute, if any
+    char* _stack = nullptr;   // individual stack, allocated on first use
+
+    // Expires once the job we're running on the shared stack finishes, so
+    // that fibers anchored to us can tell that our frames are gone. Created
+    // on demand.
+    std::shared_ptr<bool> _job;
+    std::weak_ptr<bool> _anchor_job; // `_anchor`'s `_job` at the time we got anchored to it
+
+    // Copy of our part of the shared stack while another fiber is using it.
+    struct {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        size_t capacity = 0;
+    } _saved;
 
     ucontext_t _uctx{};
     jmp_buf _fiber{};
-    jmp_buf _trampoline{};
     jmp_buf _parent{};
 
 #ifdef HILTI_HAVE_SANITIZER
@@ -115,6 +186,83 @@ private:
     inline static uint64_t _total_fibers;
     inline static uint64_t _current_fibers;
     inline static uint64_t _max_fibers;
+    inline static uint64_t _total_switches;
+    inline static uint64_t _total_functions;
+    inline static uint64_t _total_yields;
+    inline static uint64_t _max_yields;
+    inline static uint64_t _total_direct;
+    inline static uint64_t _individual_stacks;
+    inline static uint64_t _saved_bytes;
+    inline static uint64_t _stack_copies;
+    inline static Fiber* _current = nullptr;
+};
+
+/**
+ * The stack that fibers share by default, along with the state needed for
+ * switching its content between them.
+ */
+struct SharedStack {
+    SharedStack();
+    ~SharedStack();
+
+    SharedStack(const SharedStack&) = delete;
+    SharedStack(SharedStack&&) = delete;
+    SharedStack& operator=(const SharedStack&) = delete;
+    SharedStack& operator=(SharedStack&&) = delete;
+
+    /** Returns true if an address is located on the shared stack. */
+    bool contains(const void* p) const { return p >= bottom && p < bottom + size; }
+
+    /**
+     * Ensures that the stack holds a fiber's frames, first saving away those
+     * of the fiber currently owning it. Must not be called while executing
+     * on the shared stack.
+     *
+     * @param f fiber to prepare the stack for
+     * @param fresh true if *f* is about to start from scratch, so that there
+     * are no frames to restore
+     */
+    void prepare(Fiber* f, bool fresh);
+
+    /**
+     * Entry point for the switcher context, which performs the copying
+     * when control moves between two places both located on the shared
+     * stack.
+     */
+    [[noreturn]] void runSwitcher();
+
+    char* bottom = nullptr;
+    size_t size = 0;
+    Fiber* owner = nullptr;         // fiber whose frames currently reside on the stack, if any
+    const char* owner_sp = nullptr; // lowest address in use by the owner when it last switched away
+
+    ucontext_t switcher{};
+    char* switcher_stack = nullptr;
+    jmp_buf switcher_loop{};
+    jmp_buf switcher_init{};
+    Fiber* pending_owner = nullptr;
+    jmp_buf* pending_target = nullptr;
+    Fiber* pending_start = nullptr;
+};
+
+/**
+ * Helper setting up the context for executing a function directly on the
+ * current stack instead of inside a fiber. During its life-time, attempts
+ * to yield will raise an exception rather than suspending any fiber that
+ * the caller may be running in.
+ */
+class DirectExecution {
+public:
+    DirectExecution();
+    ~DirectExecution();
+
+    DirectExecution(const DirectExecution&) = delete;
+    DirectExecution(DirectExecution&&) = delete;
+    DirectExecution& operator=(const DirectExecution&) = delete;
+    DirectExecution& operator=(DirectExecution&&) = delete;
+
+private:
+    resumable::Handle* _old;
 };
 
 extern void yield();
@@ -168,6 +316,31 @@ public:
             detail::Fiber::destroy(std::move(_fiber));
     }
 
+    /**
+     * Executes a function directly on the caller's stack, without setting
+     * up a fiber. This avoids the cost of a fiber for functions known to
+     * run to completion without suspending. If the function attempts to
+     * yield nonetheless, that raises an exception.
+     *
+     * @param f function to be executed
+     * @return an instance that has already completed
+     */
+    template<typename Function, typename = std::enable_if_t<std::is_invocable<Function, resumable::Handle*>::value>>
+    static Resumable direct(Function f) {
+        Resumable r;
+        detail::DirectExecution _;
+
+        using R = decltype(f(static_cast<resumable::Handle*>(nullptr)));
+        if constexpr ( std::is_same<R, void>::value ) {
+            f(nullptr);
+            r._result = true;
+        }
+        else // NOLINT
+            r._result = f(nullptr);
+
+        return r;
+    }
+
     /** Starts execution of the function. This must be called only once. */
     void run();
 
@@ -3,10 +3,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <hilti/rt/context.h>
 #include <hilti/rt/debug-logger.h>
 #include <hilti/rt/init.h>
+#include <hilti/rt/profiler.h>
 
 // We collect all (or most) of the runtime's global state centrally. That's
 // 1st good to see what we have (global state should be minimal) and 2nd
@@ -52,9 +55,15 @@ struct GlobalState {
     /** The context for the main thread. */
     std::unique_ptr<hilti::rt::Context> master_context;
 
+    /** Stack shared by fibers, allocated on first use. */
+    std::unique_ptr<SharedStack> shared_stack;
+
     /** Cache of previously used fibers available for reuse. */
     std::vector<std::unique_ptr<Fiber>> fiber_cache;
 
+    /** Measurements recorded by the profiler, indexed by name. */
+    std::unordered_map<std::string, profiler::Measurement> profilers;
+
     /**
      * List of HILTI modules registered with the runtime. This is filled through `registerModule()`, which in turn gets
      * called through a module's global constructors at initialization time.
@@ -118,3 +127,14 @@ inline auto initModuleGlobals(unsigned int idx) {
 }
 
 } // namespace hilti::rt::detail
+
+namespace hilti::rt::profiler::detail {
+
+/**
+ * Returns true if any profiling has taken place so far. This is inline so
+ * that checking it costs next to nothing on hot paths while profiling
+ * remains disabled.
+ */
+inline bool isActive() { return ! ::hilti::rt::detail::globalState()->profilers.empty(); }
+
+} // namespace hilti::rt::profiler::detail
@@ -162,6 +162,18 @@ private:
     const T& _t;
 };
 
+/** Proxy class returned by `unsafe_range`.  */
+template<typename T>
+class UnsafeRange {
+public:
+    UnsafeRange(const T& t) : _t(t) {}
+    auto begin() const { return _t.unsafeBegin(); }
+    auto end() const { return _t.unsafeEnd(); }
+
+private:
+    const T& _t;
+};
+
 } // namespace detail::iterator
 
 /**
@@ -173,4 +185,16 @@ auto range(const T& t) {
     return detail::iterator::Range(t);
 }
 
+/**
+ * Wrapper that returns an object suitable to operate a range-based for
+ * loop on to iterate over a container's storage directly. This bypasses
+ * all safe iterator checks, and doesn't need the container's control
+ * block either. It must only be used if the container is guaranteed to
+ * remain unchanged, and alive, during the iteration.
+ */
+template<typename T>
+auto unsafe_range(const T& t) {
+    return detail::iterator::UnsafeRange(t);
+}
+
 } // namespace hilti::rt
@@ -10,6 +10,7 @@
 #include <hilti/rt/hilti.h>
 #include <hilti/rt/init.h>
 #include <hilti/rt/logging.h>
+#include <hilti/rt/profiler.h>
 #include <hilti/rt/result.h>
 #include <hilti/rt/safe-int.h>
 #include <hilti/rt/types/all.h>
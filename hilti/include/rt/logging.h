@@ -76,22 +76,30 @@ inline void dedent(const std::string& stream) {
         ::hilti::rt::detail::globalState()->debug_logger->dedent(stream);
 }
 
+namespace detail {
+/**
+ * Helper returning a reference to a thread-local variable storing the most
+ * recent source code location recorded by generated code. Keeping it
+ * outside of the current context avoids a null check on each update. As
+ * with `context::detail::current()`, we can't access the variable directly
+ * from JITted code.
+ *
+ * Normally, this function should not be used; use
+ * `location()`/`setLocation()` instead.
+ */
+extern const char*& current_location();
+} // namespace detail
+
 /**
  * Returns the current source code location if set, or null if not.
  */
-inline const char* location() {
-    const auto context = ::hilti::rt::context::detail::current();
-    return context ? context->source_location : nullptr;
-}
+inline const char* location() { return detail::current_location(); }
 
 /**
  * Sets the current source code location; or unsets if no argumet.
  * *loc* must point to a static string that won't go out of scope.
  */
-inline void setLocation(const char* l = nullptr) {
-    if ( auto context = ::hilti::rt::context::detail::current() )
-        context->source_location = l;
-}
+inline void setLocation(const char* l = nullptr) { detail::current_location() = l; }
 
 } // namespace debug
 } // namespace hilti::rt
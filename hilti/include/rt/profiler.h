@@ -0,0 +1,103 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+/**
+ * API to measure execution of generated code at runtime. Code generators
+ * instrument blocks of code with calls to `profiler::start()` and
+ * `profiler::stop()` only when asked to do so, so that there's no overhead
+ * if profiling isn't in use.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace hilti::rt {
+
+class Profiler;
+
+namespace profiler {
+
+/** Aggregated measurements recorded for one profiled block of code. */
+struct Measurement {
+    uint64_t count = 0;  /**< number of times the block was executed */
+    uint64_t time = 0;   /**< total execution time in nanoseconds, not counting time while suspended */
+    uint64_t volume = 0; /**< total amount of data processed, per caller-defined unit (e.g., bytes of input) */
+    uint64_t yields = 0; /**< number of times execution got suspended while inside the block */
+};
+
+/**
+ * Begins measuring execution of a block of code.
+ *
+ * @param name name of the block; all measurements with the same name are
+ * aggregated
+ *
+ * @param volume current value of a caller-defined counter, such as the
+ * current input offset; the difference to the value passed to `stop()` will
+ * be recorded as the volume processed
+ *
+ * @return handle to pass to `stop()`
+ */
+extern Profiler start(const std::string& name, uint64_t volume = 0);
+
+/**
+ * Finishes measuring execution of a block of code.
+ *
+ * @param p handle returned by the corresponding `start()`
+ * @param volume current value of the caller-defined counter passed to `start()`
+ */
+extern void stop(const Profiler& p, uint64_t volume = 0);
+
+} // namespace profiler
+
+/**
+ * Handle for a currently running measurement. Returned by
+ * `profiler::start()`, and to be passed to `profiler::stop()` once the
+ * profiled block has finished.
+ */
+class Profiler {
+public:
+    Profiler() = default;
+
+private:
+    friend Profiler profiler::start(const std::string& name, uint64_t volume);
+    friend void profiler::stop(const Profiler& p, uint64_t volume);
+
+    profiler::Measurement* _measurement = nullptr;
+    uint64_t _time = 0;
+    uint64_t _volume = 0;
+    uint64_t _suspended = 0;
+    uint64_t _yields = 0;
+};
+
+namespace profiler {
+
+/** Returns the aggregated measurements for a block, if any have been recorded. */
+extern std::optional<Measurement> get(const std::string& name);
+
+/** Returns all aggregated measurements recorded so far, indexed by name. */
+extern std::map<std::string, Measurement> all();
+
+/** Discards all measurements recorded so far. */
+extern void reset();
+
+/**
+ * Renders a summary of all measurements recorded so far. Does nothing if
+ * there aren't any.
+ */
+extern void report(std::ostream& out);
+
+namespace detail {
+
+// `isActive()` is defined inline in `global-state.h`, as it needs the global state.
+
+/** Returns the current time as used for measurements, in nanoseconds. */
+extern uint64_t now();
+
+} // namespace detail
+
+} // namespace profiler
+} // namespace hilti::rt
@@ -9,6 +9,7 @@
 #include <hilti/rt/types/function.h>
 #include <hilti/rt/types/integer.h>
 #include <hilti/rt/types/interval.h>
+#include <hilti/rt/types/literal-set.h>
 #include <hilti/rt/types/map.h>
 #include <hilti/rt/types/network.h>
 #include <hilti/rt/types/null.h>
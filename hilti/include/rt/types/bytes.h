@@ -212,6 +212,12 @@ public:
     /** Returns an iterator representing the end of the instance. */
     const_iterator end() const { return const_iterator(size(), _control); }
 
+    /** Returns a raw pointer to the first byte, see `unsafe_range()`. */
+    const uint8_t* unsafeBegin() const { return reinterpret_cast<const uint8_t*>(data()); }
+
+    /** Returns a raw pointer past the last byte, see `unsafe_range()`. */
+    const uint8_t* unsafeEnd() const { return reinterpret_cast<const uint8_t*>(data()) + size(); }
+
     /** Returns an iterator referring to the given offset. */
     const_iterator at(Offset o) const { return begin() + o; }
 
@@ -3,8 +3,10 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstring>
 #include <limits>
 #include <tuple>
+#include <type_traits>
 
 #include <hilti/rt/extension-points.h>
 #include <hilti/rt/result.h>
@@ -147,6 +149,48 @@ inline Result<std::tuple<integer::safe<T>, D>> unpack(D b, ByteOrder fmt) {
     cannot_be_reached();
 }
 
+/**
+ * Unpacks an integer in a byte order that's known at compile time. This
+ * works like the version receiving the byte order as an argument, but
+ * turns into a plain load from the data, followed by a byte swap if the
+ * byte order differs from the host's.
+ */
+template<typename T, ByteOrder BO, typename D>
+inline Result<std::tuple<integer::safe<T>, D>> unpack(D b) {
+    if constexpr ( BO == ByteOrder::Undef )
+        return result::Error("undefined byte order");
+
+    else {
+        if ( b.size() < static_cast<int64_t>(sizeof(T)) )
+            return result::Error("insufficient data to unpack integer");
+
+        uint8_t raw[sizeof(T)];
+        b = b.extract(raw);
+
+        std::make_unsigned_t<T> x;
+        memcpy(&x, raw, sizeof(T));
+
+        if constexpr ( sizeof(T) > 1 ) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            constexpr bool swap = (BO == ByteOrder::Big || BO == ByteOrder::Network);
+#else
+            constexpr bool swap = (BO == ByteOrder::Little);
+#endif
+            if constexpr ( swap ) {
+                if constexpr ( sizeof(T) == 2 )
+                    x = __builtin_bswap16(x);
+                else if constexpr ( sizeof(T) == 4 )
+                    x = __builtin_bswap32(x);
+                else
+                    x = __builtin_bswap64(x);
+            }
+        }
+
+        auto v = static_cast<T>(x); // Forced cast to skip safe<T> range check.
+        return std::make_tuple(static_cast<integer::safe<T>>(v), std::move(b));
+    }
+}
+
 /**
  * Converts a 64-bit value from host-order to network order.
  *
@@ -253,8 +297,13 @@ inline hilti::rt::integer::safe<UINT> bits(hilti::rt::integer::safe<UINT> v, uin
     }
 
     assert(lower <= upper);
-    auto mask = ((1U << (upper - lower + 1)) - 1U) << lower;
-    return (v & mask) >> lower;
+
+    // Operate on the raw value, the mask keeps this in range. With
+    // constant arguments, this reduces to a single shift and mask.
+    const auto n = upper - lower + 1;
+    const auto mask = (n >= static_cast<uint64_t>(width) ? std::numeric_limits<UINT>::max() :
+                                                           static_cast<UINT>((static_cast<UINT>(1) << n) - 1U));
+    return static_cast<UINT>((v.Ref() >> lower) & mask);
 }
 
 } // namespace integer
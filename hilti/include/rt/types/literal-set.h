@@ -0,0 +1,157 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include <hilti/rt/exception.h>
+#include <hilti/rt/extension-points.h>
+#include <hilti/rt/types/bytes.h>
+#include <hilti/rt/types/stream.h>
+#include <hilti/rt/types/vector.h>
+
+namespace hilti::rt {
+
+class LiteralSet;
+
+namespace literal_set {
+
+namespace detail {
+struct Automaton;
+} // namespace detail
+
+/**
+ * State for searching a stream incrementally for the literals of a
+ * `LiteralSet`, with the data arriving chunk by chunk. Literals may span
+ * chunks.
+ */
+class Scanner {
+public:
+    /** Creates a fresh instance ready to search for the literals of a given set. */
+    Scanner(const LiteralSet& literals);
+    Scanner() = default;
+
+    /**
+     * Feeds the next chunk of data into the scanner, continuing where the
+     * previous chunk left off. Scanning stops at the first match, and
+     * subsequent calls will continue right after that.
+     *
+     * @param data chunk of data; if the underlying stream is frozen, this
+     * will be assumed to be the last chunk of data
+     *
+     * @returns A tuple in which the integer is: (1) larger than zero if a
+     * literal has been found, indicating its index inside the set plus one;
+     * (2) zero if no match was found and the stream is frozen, so that
+     * there's no further data that could change that; (3) smaller than 0
+     * if no match was found so far but advancing further may change that.
+     * In either case, the returned view trims *data* to the part not
+     * consumed yet.
+     */
+    std::tuple<int32_t, stream::View> advance(const stream::View& data);
+
+    /**
+     * Returns the length of the literal found by the most recent successful
+     * call to `advance()`, or zero if there hasn't been any.
+     */
+    uint64_t matchLength() const { return _match_length; }
+
+private:
+    std::shared_ptr<const detail::Automaton> _automaton;
+    uint32_t _state = 0;
+    uint64_t _match_length = 0;
+};
+
+} // namespace literal_set
+
+/**
+ * A set of byte literals to search for jointly, at the cost of a single
+ * pass over the data independent of how many literals there are. We
+ * compile the literals into an Aho-Corasick automaton with the
+ * transitions precomputed into a table indexed by classes of equivalent
+ * input bytes.
+ *
+ * When multiple literals occur inside the data, the one ending first
+ * gets reported; and, if there's more than one of those, the longest.
+ */
+class LiteralSet {
+public:
+    /**
+     * Instantiates a new set.
+     *
+     * @param literals literals to search for; IDs reported by searches
+     * correspond to their index inside the vector, plus one
+     * @exception `InvalidArgument` if any of the literals is empty
+     */
+    LiteralSet(const Vector<Bytes>& literals);
+
+    /** Instantiates an empty set, which never finds anything. */
+    LiteralSet() = default;
+
+    /** Returns the number of literals in the set. */
+    uint64_t size() const;
+
+    /**
+     * Searches data for the first occurrence of any of the literals.
+     *
+     * @return A tuple in which the integer is larger than zero if a literal
+     * has been found, indicating its index inside the set plus one; and
+     * zero otherwise. If found, the 2nd element is the matching part of
+     * the data.
+     */
+    std::tuple<int32_t, Bytes> find(const Bytes& data) const;
+
+    /**
+     * Searches data for the first occurrence of any of the literals.
+     *
+     * @return A tuple in which the integer is larger than zero if a literal
+     * has been found, indicating its index inside the set plus one; and
+     * zero otherwise. If found, the 2nd element is a view of the matching
+     * part of the data; if not, it's an empty view at the end of the data.
+     */
+    std::tuple<int32_t, stream::View> find(const stream::View& data) const;
+
+    /** Returns a scanner for searching for the set's literals incrementally. */
+    literal_set::Scanner scanner() const { return literal_set::Scanner(*this); }
+
+private:
+    friend class literal_set::Scanner;
+
+    std::shared_ptr<const literal_set::detail::Automaton> _automaton;
+};
+
+namespace literal_set {
+
+/** Returns a set compiled from the given literals. */
+inline LiteralSet compile(const Vector<Bytes>& literals) { return LiteralSet(literals); }
+
+/** Forwards to the corresponding `LiteralSet` method. */
+inline std::tuple<int32_t, stream::View> find(const LiteralSet& literals, const stream::View& data) {
+    return literals.find(data);
+}
+
+/** Returns a scanner for searching for the set's literals incrementally. */
+inline Scanner scanner(const LiteralSet& literals) { return literals.scanner(); }
+
+/** Forwards to the corresponding `Scanner` method. */
+inline std::tuple<int32_t, stream::View> advance(Scanner& scanner, const stream::View& data) {
+    return scanner.advance(data);
+}
+
+/** Forwards to the corresponding `Scanner` method. */
+inline uint64_t match_length(const Scanner& scanner) { return scanner.matchLength(); }
+
+} // namespace literal_set
+
+namespace detail::adl {
+inline std::string to_string(const LiteralSet& /*unused*/, adl::tag /*unused*/) {
+    return "<literal-set>";
+}
+
+inline std::string to_string(const literal_set::Scanner& /*unused*/, adl::tag /*unused*/) {
+    return "<literal-set-scanner>";
+}
+} // namespace detail::adl
+
+} // namespace hilti::rt
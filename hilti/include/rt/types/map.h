@@ -291,6 +291,12 @@ public:
 
     auto cend() const { return const_iterator(static_cast<const M&>(*this).end(), _control); }
 
+    /** Returns a raw iterator to the first element, see `unsafe_range()`. */
+    auto unsafeBegin() const { return M::cbegin(); }
+
+    /** Returns a raw iterator past the last element, see `unsafe_range()`. */
+    auto unsafeEnd() const { return M::cend(); }
+
 
     /** Erases all elements from the map.
      *
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <optional>
+#include <type_traits>
 
 #include <hilti/rt/extension-points.h>
 #include <hilti/rt/types/bytes.h>
@@ -94,11 +95,16 @@ public:
 private:
     std::pair<int32_t, uint64_t> _advance(const stream::View& data, bool is_final);
 
-    // TODO(robin): PIMPLing here means we have to alllocate dynamic memory, which
-    // isn't great for this class. However, without PIMPL we get a new dependency on
-    // 'jrx.h', which isn't great either. Better ideas?
+    // We keep the implementation in inline storage, rather than behind a
+    // pointer, so that creating a match state for every token doesn't need
+    // to allocate dynamic memory. That still avoids a dependency on 'jrx.h';
+    // the implementation checks that the space reserved here suffices.
     class Pimpl;
-    std::unique_ptr<Pimpl> _pimpl;
+    Pimpl* _pimpl() const; // Returns null if not initialized.
+    void _reset();
+
+    std::aligned_storage_t<128, alignof(void*)> _storage;
+    bool _initialized = false;
 };
 
 } // namespace regexp
@@ -166,6 +172,21 @@ public:
      */
     Vector<Bytes> findGroups(const Bytes& data) const;
 
+    /**
+     * Checks whether a block of raw data begins with a match of the regular
+     * expression, without needing to copy the data first. The regular
+     * expression is considered implicitly anchored, and must have been
+     * compiled with the `&nosub` attribute.
+     *
+     * @return If the returned integer is larger than zero, a prefix of the
+     * data matches; for sets compiled via `compileSet` the integer value
+     * then indicates the ID of the pattern that matched. If the function
+     * returns zero, there's no match and that won't change if further data
+     * gets added to the input. If the returned value is smaller than 0,
+     * further data could still lead to a match.
+     */
+    int32_t matchPrefix(const char* data, size_t size) const;
+
     /**
      * Returns matching state initializes for incremental token matching. For
      * token matching the regular expression will be considered implicitly
@@ -174,6 +195,18 @@ public:
      */
     regexp::MatchState tokenMatcher() const;
 
+    /** Statistics about regular expression matching across all instances. */
+    struct Statistics {
+        uint64_t dfa_states;            // number of DFA states computed so far
+        uint64_t dfa_states_cached;     // number of DFA states currently kept in memory
+        uint64_t dfa_state_sets_cached; // number of NFA state sets currently kept in memory for DFA states
+        uint64_t dfa_flushes;           // number of times a DFA's states were discarded for exceeding the limit
+        uint64_t matches;               // number of matching operations performed so far
+    };
+
+    /** Returns statistics about regular expression matching across all instances. */
+    static Statistics statistics();
+
 private:
     friend class regexp::MatchState;
 
@@ -183,6 +216,28 @@ private:
     }
     const auto& _jrxShared() const { return _jrx_shared; }
 
+    // Returns an unanchored version of the regexp without capture groups
+    // that stops at the first accepting state, for single-pass searching.
+    // Compiled on first use.
+    jrx_regex_t* _jrxSearch() const;
+
+    // Returns an anchored version of the regexp without capture groups. For
+    // `&nosub` regexps, that's the regexp itself; otherwise it's compiled
+    // on first use.
+    jrx_regex_t* _jrxAnchored() const;
+
+    // Returns an anchored version of the regexp with capture groups.
+    // Compiled on first use.
+    jrx_regex_t* _jrxAnchoredGroups() const;
+
+    // Returns an unanchored regexp without capture groups that matches the
+    // reverse of what the regexp's patterns match, or null if we couldn't
+    // reverse them. Compiled on first use.
+    jrx_regex_t* _jrxReverse() const;
+
+    // Compiles a set of patterns with different flags than the regexp itself.
+    std::shared_ptr<jrx_regex_t> _compileVariant(const std::vector<std::string>& patterns, int cflags) const;
+
     /**
      * Searches for the regexp anywhere inside a bytes instance and returns
      * the first match.
@@ -192,11 +247,21 @@ private:
 
     void _newJrx();
     void _compileOne(std::string pattern, int idx);
+    void _prepareSearch();
 
     regexp::Flags _flags{};
     std::vector<std::string> _patterns;
     std::shared_ptr<jrx_regex_t>
         _jrx_shared; // Shared ptr so that we can copy by value, and safely share with match state.
+    mutable std::shared_ptr<jrx_regex_t> _jrx_search;          // See _jrxSearch().
+    mutable std::shared_ptr<jrx_regex_t> _jrx_anchored;        // See _jrxAnchored().
+    mutable std::shared_ptr<jrx_regex_t> _jrx_anchored_groups; // See _jrxAnchoredGroups().
+    mutable std::shared_ptr<jrx_regex_t> _jrx_reverse;         // See _jrxReverse().
+    std::vector<std::string> _reversed_patterns; // Reversed patterns; empty if we couldn't reverse all of them.
+    bool _linear_search = false; // True if _search_pattern() can use _jrxSearch().
+    std::string _prefix;         // Literal that all matches start with; empty if unknown.
+
+    inline static uint64_t _total_matches;
 };
 
 namespace detail::adl {
@@ -141,6 +141,12 @@ public:
 
     auto end() const { return iterator(static_cast<const V&>(*this).end(), empty() ? nullptr : _control); }
 
+    /** Returns a raw iterator to the first element, see `unsafe_range()`. */
+    auto unsafeBegin() const { return V::cbegin(); }
+
+    /** Returns a raw iterator past the last element, see `unsafe_range()`. */
+    auto unsafeEnd() const { return V::cend(); }
+
     /** Removes an element from the set.
      *
      * This function invalidates all iterators into the set.
@@ -169,10 +169,51 @@ struct Chain {
     std::shared_ptr<Chunk> head;
     std::shared_ptr<Chunk> tail;
 
-    Chain(Chunk&& ch) : head(std::make_shared<Chunk>(std::move(ch))), tail(head) {}
-    Chain(const std::string& data) : head(std::make_shared<Chunk>(data)), tail(head) {}
-    Chain(std::shared_ptr<Chunk>&& head, std::shared_ptr<Chunk>&& tail)
-        : head(std::move(head)), tail(std::move(tail)) {}
+    Chain(Chunk&& ch) : head(std::make_shared<Chunk>(std::move(ch))), tail(head) { added(1, head->size()); }
+    Chain(const std::string& data) : head(std::make_shared<Chunk>(data)), tail(head) { added(1, head->size()); }
+    Chain(std::shared_ptr<Chunk>&& head, std::shared_ptr<Chunk>&& tail);
+    ~Chain();
+
+    Chain(const Chain&) = delete;
+    Chain(Chain&&) = delete;
+    Chain& operator=(const Chain&) = delete;
+    Chain& operator=(Chain&&) = delete;
+
+    /** Statistics about the chunks held by all stream instances. */
+    struct Statistics {
+        uint64_t chunks;        /**< number of chunks currently allocated */
+        uint64_t max_chunks;    /**< high-water mark for number of chunks allocated */
+        uint64_t bytes;         /**< number of bytes currently stored inside chunks */
+        uint64_t max_bytes;     /**< high-water mark for number of bytes stored inside chunks */
+        uint64_t bytes_trimmed; /**< total number of bytes released through trimming */
+    };
+
+    /** Returns statistics about the chunks held by all stream instances. */
+    static Statistics statistics() { return _statistics; }
+
+    /** Records that chunks have been added to a chain. */
+    static void added(uint64_t chunks, uint64_t bytes) {
+        _statistics.chunks += chunks;
+        _statistics.bytes += bytes;
+
+        if ( _statistics.chunks > _statistics.max_chunks )
+            _statistics.max_chunks = _statistics.chunks;
+
+        if ( _statistics.bytes > _statistics.max_bytes )
+            _statistics.max_bytes = _statistics.bytes;
+    }
+
+    /** Records that chunks, or parts of them, have been removed from a chain. */
+    static void removed(uint64_t chunks, uint64_t bytes, bool trimmed) {
+        _statistics.chunks -= chunks;
+        _statistics.bytes -= bytes;
+
+        if ( trimmed )
+            _statistics.bytes_trimmed += bytes;
+    }
+
+private:
+    inline static Statistics _statistics;
 };
 
 } // namespace detail
@@ -673,6 +714,18 @@ public:
      */
     template<int N>
     View extract(Byte (&dst)[N]) const {
+        // Fast path: If all the data is available inside the current chunk,
+        // copy it over directly.
+        if ( auto c = _begin.chunk() ) {
+            auto offset = _begin.offset();
+
+            if ( offset >= c->offset() && offset + N <= c->offset() + c->size() &&
+                 (! _end || offset + N <= _end->offset()) ) {
+                memcpy(dst, c->begin() + (offset - c->offset()).Ref(), N);
+                return View(_begin + N, _end);
+            }
+        }
+
         return View(SafeConstIterator(detail::extract<N>(dst, detail::UnsafeConstIterator(_begin), end())), _end);
     }
 
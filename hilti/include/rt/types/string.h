@@ -35,6 +35,24 @@ std::string lower(const std::string& s);
  */
 std::string upper(const std::string& s);
 
+namespace detail {
+
+/**
+ * Returns the length of the initial run of 7-bit ASCII characters inside
+ * a buffer. This inspects the data a machine word at a time, so that
+ * callers can handle runs of ASCII in bulk.
+ */
+size_t asciiPrefix(const char* data, size_t size);
+
+/**
+ * Returns the length of the initial run of printable 7-bit ASCII
+ * characters inside a buffer. Like `asciiPrefix()`, this inspects the data
+ * a machine word at a time.
+ */
+size_t printablePrefix(const char* data, size_t size);
+
+} // namespace detail
+
 } // namespace string
 
 namespace detail::adl {
@@ -249,7 +249,11 @@ public:
     using const_iterator = vector::ConstIterator<T, Allocator>;
 
     using C = std::shared_ptr<Vector*>;
-    C _control = std::make_shared<Vector<T, Allocator>*>(this);
+
+    // Control block for the instance's safe iterators. We create this only
+    // once the first iterator gets requested, so that vectors that are
+    // never iterated over don't pay for the additional allocation.
+    mutable C _control;
 
     Vector() = default;
 
@@ -386,14 +390,20 @@ public:
         return *this;
     }
 
-    auto begin() { return iterator(0u, _control); }
-    auto end() { return iterator(size(), _control); }
+    auto begin() { return iterator(0u, _getControl()); }
+    auto end() { return iterator(size(), _getControl()); }
+
+    auto begin() const { return const_iterator(0u, _getControl()); }
+    auto end() const { return const_iterator(size(), _getControl()); }
 
-    auto begin() const { return const_iterator(0u, _control); }
-    auto end() const { return const_iterator(size(), _control); }
+    auto cbegin() const { return const_iterator(0u, _getControl()); }
+    auto cend() const { return const_iterator(size(), _getControl()); }
 
-    auto cbegin() const { return const_iterator(0u, _control); }
-    auto cend() const { return const_iterator(size(), _control); }
+    /** Returns a raw iterator to the first element, see `unsafe_range()`. */
+    auto unsafeBegin() const { return V::cbegin(); }
+
+    /** Returns a raw iterator past the last element, see `unsafe_range()`. */
+    auto unsafeEnd() const { return V::cend(); }
 
     // Methods of `std::vector`.
     using typename V::value_type;
@@ -409,6 +419,14 @@ public:
     friend bool operator==(const Vector& a, const Vector& b) {
         return static_cast<const V&>(a) == static_cast<const V&>(b);
     }
+
+private:
+    const C& _getControl() const {
+        if ( ! _control )
+            _control = std::make_shared<Vector*>(const_cast<Vector*>(this));
+
+        return _control;
+    }
 };
 
 namespace vector {
@@ -67,6 +67,33 @@ struct MemoryStatistics {
 /** Returns statistics about the current state of memory allocations. */
 MemoryStatistics memory_statistics();
 
+/** Statistics about the runtime's current state and its activity so far. */
+struct RuntimeStatistics {
+    // Note when changing this, update `runtime_statistics()`.
+    uint64_t memory_heap;          //< current size of heap in bytes
+    uint64_t stream_chunks;        //< number of stream chunks currently allocated
+    uint64_t max_stream_chunks;    //< high-water mark for number of stream chunks allocated
+    uint64_t stream_bytes;         //< number of bytes currently stored inside streams
+    uint64_t max_stream_bytes;     //< high-water mark for number of bytes stored inside streams
+    uint64_t stream_bytes_trimmed; //< total number of bytes trimmed off streams
+    uint64_t num_fibers;           //< number of fibers currently in use
+    uint64_t max_fibers;           //< high-water mark for number of fibers in use
+    uint64_t cached_fibers;        //< number of fibers currently cached for reuse
+    uint64_t fiber_stack_bytes;    //< size of stacks currently allocated for fibers, in bytes
+    uint64_t fiber_switches;       //< number of times execution switched into a fiber
+    uint64_t resumables;           //< number of functions that finished executing inside a fiber
+    uint64_t resumable_yields;     //< total number of yields across these functions
+    uint64_t max_resumable_yields; //< largest number of yields by a single function
+    uint64_t resumables_direct;    //< number of functions executed directly, without a fiber
+    uint64_t regexp_dfa_states;    //< number of regexp DFA states computed
+    uint64_t regexp_dfa_cached;    //< number of regexp DFA states currently kept in memory
+    uint64_t regexp_dfa_flushes;   //< number of times a regexp's DFA states were discarded for exceeding the limit
+    uint64_t regexp_matches;       //< number of regexp matching operations performed
+};
+
+/** Returns statistics about the runtime's current state and its activity so far. */
+RuntimeStatistics runtime_statistics();
+
 /**
  * Creates a temporary file in the system temporary directory.
  *
@@ -1,3 +1,45 @@
 // Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
 
+#include <hilti/ast/ctors/coerced.h>
+#include <hilti/ast/ctors/enum.h>
+#include <hilti/ast/declarations/constant.h>
 #include <hilti/ast/expression.h>
+#include <hilti/ast/expressions/coerced.h>
+#include <hilti/ast/expressions/ctor.h>
+#include <hilti/ast/expressions/grouping.h>
+#include <hilti/ast/expressions/id.h>
+#include <hilti/ast/expressions/type-wrapped.h>
+
+using namespace hilti;
+
+std::optional<ID> expression::constantEnumLabel(const Expression& e) {
+    if ( auto x = e.tryAs<expression::Ctor>() ) {
+        auto ctor = x->ctor();
+
+        if ( auto c = ctor.tryAs<ctor::Coerced>() )
+            ctor = c->coercedCtor();
+
+        if ( auto l = ctor.tryAs<ctor::Enum>() )
+            return l->value().id();
+
+        return {};
+    }
+
+    if ( auto x = e.tryAs<expression::ResolvedID>() ) {
+        if ( auto c = x->declaration().tryAs<declaration::Constant>() )
+            return constantEnumLabel(c->value());
+
+        return {};
+    }
+
+    if ( auto x = e.tryAs<expression::Coerced>() )
+        return constantEnumLabel(x->expression());
+
+    if ( auto x = e.tryAs<expression::Grouping>() )
+        return constantEnumLabel(x->expression());
+
+    if ( auto x = e.tryAs<expression::TypeWrapped>() )
+        return constantEnumLabel(x->expression());
+
+    return {};
+}
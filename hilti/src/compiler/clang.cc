@@ -89,6 +89,7 @@
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/Internalize.h>
 #include <llvm/Transforms/InstCombine/InstCombine.h>
 #include <llvm/Transforms/Scalar.h>
@@ -464,6 +465,15 @@ Result<Nothing> ClangJIT::Implementation::jit() {
 void ClangJIT::Implementation::optimizeModule(llvm::Module* m) {
     HILTI_DEBUG(logging::debug::Jit, util::fmt("optimizing module %s", m->getModuleIdentifier()));
 
+    // Now that all units are linked together, inline small functions across
+    // them. That in particular resolves hook calls at their call sites: calls
+    // to hooks without implementations go away, and hooks with a single
+    // implementation get called directly.
+    llvm::legacy::PassManager mpm;
+    mpm.add(llvm::createFunctionInliningPass());
+    mpm.add(llvm::createGlobalDCEPass());
+    mpm.run(*m);
+
     auto fpm = std::make_unique<llvm::legacy::FunctionPassManager>(m);
     // These are the reccomended optimization passes from
     // LLVM's build a JIT tutorial.
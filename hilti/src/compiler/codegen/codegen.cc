@@ -361,6 +361,23 @@ struct Visitor : hilti::visitor::PreOrder<void, Visitor> {
             auto rt = (ft.result().type() != type::Void() ? " -> std::any" : "");
             body.addLambda("cb", fmt("[&](hilti::rt::resumable::Handle* r)%s", rt), std::move(cb));
 
+            // If all input streams the function receives are frozen
+            // already, it cannot suspend waiting for more data. We then
+            // execute it directly on the caller's stack, saving the
+            // overhead of switching to a fiber.
+            std::vector<std::string> frozen;
+
+            for ( const auto& p : ft.parameters() ) {
+                if ( auto t = p.type().tryAs<type::ValueReference>(); t && t->dereferencedType().isA<type::Stream>() )
+                    frozen.push_back(fmt("%s->isFrozen()", cxx::ID(p.id())));
+            }
+
+            if ( ! frozen.empty() ) {
+                auto direct = cxx::Block();
+                direct.addReturn("hilti::rt::Resumable::direct(std::move(cb))");
+                body.addIf(util::join(frozen, " && "), std::move(direct));
+            }
+
             body.addLocal(
                 cxx::declaration::Local{.id = "r", .type = "hilti::rt::Resumable", .init = "{std::move(cb)}"});
             body.addStatement("r.run()");
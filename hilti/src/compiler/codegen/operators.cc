@@ -376,7 +376,14 @@ struct Visitor : hilti::visitor::PreOrder<std::string, Visitor> {
     result_t operator()(const operator_::result::Error& n) { return fmt("%s.errorOrThrow()", op0(n)); }
 
     result_t operator()(const operator_::generic::Unpack& n) {
-        auto args = tupleArguments(n, n.op1());
+        // Pass on the arguments uncompiled so that unpacking can specialize
+        // on the ones known at compile time.
+        auto ctor = n.op1().as<expression::Ctor>().ctor();
+
+        if ( auto x = ctor.tryAs<ctor::Coerced>() )
+            ctor = x->coercedCtor();
+
+        auto args = ctor.as<ctor::Tuple>().value();
         return cg->unpack(n.op0().type().as<type::Type_>().typeValue(), args[0], util::slice(args, 1, -1));
     }
 
@@ -181,18 +181,160 @@ struct Visitor : hilti::visitor::PreOrder<void, Visitor> {
             block->addIf(head, cg->compile(n.true_()), cg->compile(*n.false_()));
     }
 
+    // Returns true if a sequence's runtime type supports iterating over its
+    // storage directly through `hilti::rt::unsafe_range()`.
+    static bool supportsUnsafeRange(const Type& t) {
+        auto x = type::effectiveType(t);
+
+        if ( x.isA<type::Bytes>() )
+            return true;
+
+        // Empty containers without element type don't use our container classes.
+        if ( auto l = x.tryAs<type::List>() )
+            return l->elementType() != type::unknown;
+
+        if ( auto m = x.tryAs<type::Map>() )
+            return m->elementType() != type::unknown;
+
+        if ( auto s = x.tryAs<type::Set>() )
+            return s->elementType() != type::unknown;
+
+        if ( auto v = x.tryAs<type::Vector>() )
+            return v->elementType() != type::unknown;
+
+        return false;
+    }
+
+    // Returns true if an expression refers to the struct instance that a
+    // method is executing on.
+    static bool isSelf(Expression e) {
+        while ( true ) {
+            if ( auto x = e.tryAs<expression::Coerced>() )
+                e = x->expression();
+            else if ( e.isA<operator_::value_reference::Deref>() )
+                e = e.as<expression::ResolvedOperator>().op0();
+            else
+                break;
+        }
+
+        if ( auto x = e.tryAs<expression::Keyword>() )
+            return x->kind() == expression::keyword::Kind::Self;
+
+        if ( auto x = e.tryAs<expression::ResolvedID>() ) {
+            if ( auto d = x->declaration().tryAs<declaration::Expression>() )
+                return isSelf(d->expression());
+        }
+
+        return false;
+    }
+
+    // Returns true if an expression accesses a non-optional field of the
+    // struct instance that a method is executing on. (Optional fields may
+    // evaluate to a temporary default value.)
+    static bool isFieldOfSelf(const Expression& e) {
+        if ( ! (e.isA<operator_::struct_::MemberNonConst>() || e.isA<operator_::struct_::MemberConst>()) )
+            return false;
+
+        const auto& op = e.as<expression::ResolvedOperator>();
+        auto st = type::effectiveType(op.op0().type()).tryAs<type::Struct>();
+        if ( ! st )
+            return false;
+
+        auto f = st->field(op.op1().as<expression::Member>().id());
+        return f && ! f->isOptional() && isSelf(op.op0());
+    }
+
+    // Returns true if the target of an assignment may hold references to
+    // other values, so that overwriting it could release one of those.
+    static bool mayHoldReferences(const Type& t) {
+        auto x = type::effectiveType(t);
+        return type::isReferenceType(x) || x.isA<type::Struct>() || x.isA<type::Union>() || x.isA<type::Tuple>() ||
+               x.isA<type::Optional>() || x.isA<type::Result>() || x.isA<type::List>() || x.isA<type::Map>() ||
+               x.isA<type::Set>() || x.isA<type::Vector>();
+    }
+
+    // Returns true if a loop body can't modify or release any struct
+    // instance: it must not call any functions or methods, write to or
+    // unset struct fields, delete container elements, assign to anything
+    // that may hold references, or suspend execution.
+    static bool leavesStructsAlone(const Node& body) {
+        for ( const auto& i : hilti::visitor::PreOrder<>().walk(body) ) {
+            if ( i.node.isA<statement::Yield>() )
+                return false;
+
+            if ( auto x = i.node.tryAs<expression::Assign>(); x && mayHoldReferences(x->target().type()) )
+                return false;
+
+            if ( i.node.isA<operator_::struct_::MemberNonConst>() )
+                return false;
+
+            if ( auto x = i.node.tryAs<expression::ResolvedOperator>() ) {
+                switch ( x->operator_().kind() ) {
+                    case operator_::Kind::Call:
+                    case operator_::Kind::Delete:
+                    case operator_::Kind::MemberCall:
+                    case operator_::Kind::Unset: return false;
+                    default: break;
+                }
+            }
+
+            if ( i.node.isA<expression::UnresolvedOperator>() )
+                return false;
+        }
+
+        return true;
+    }
+
+    // Returns true if a loop is guaranteed to leave its sequence alone
+    // while iterating. That's the case if either:
+    //
+    // - the sequence is a local variable, which only the function's own
+    //   code can get to, and the loop body doesn't refer to it; or
+    //
+    // - the sequence is a field of `self`, and the loop body doesn't do
+    //   anything that could modify or release a struct instance.
+    static bool isUntouchedByBody(const statement::For& n) {
+        const Node body = n.body();
+
+        if ( auto rid = n.sequence().tryAs<expression::ResolvedID>();
+             rid && rid->declaration().isA<declaration::LocalVariable>() ) {
+            for ( const auto& i : hilti::visitor::PreOrder<>().walk(body) ) {
+                if ( auto x = i.node.tryAs<expression::ResolvedID>(); x && x->id() == rid->id() )
+                    return false;
+
+                if ( auto x = i.node.tryAs<expression::UnresolvedID>(); x && x->id() == rid->id() )
+                    return false;
+            }
+
+            return true;
+        }
+
+        if ( isFieldOfSelf(n.sequence()) )
+            return leavesStructsAlone(body);
+
+        return false;
+    }
+
     void operator()(const statement::For& n) {
         auto id = cxx::ID(n.id());
         auto seq = cg->compile(n.sequence());
         auto body = cg->compile(n.body());
+        auto unsafe = supportsUnsafeRange(n.sequence().type());
 
-        if ( ! n.sequence().isTemporary() )
-            block->addForRange(true, id, fmt("%s", seq), body);
+        if ( ! n.sequence().isTemporary() ) {
+            if ( unsafe && isUntouchedByBody(n) )
+                // Safe iterators won't buy us anything here, skip them.
+                block->addForRange(true, id, fmt("hilti::rt::unsafe_range(%s)", seq), body);
+            else
+                block->addForRange(true, id, fmt("%s", seq), body);
+        }
         else {
+            // The temporary copy of the sequence isn't accessible to the
+            // body, so it can't change while we iterate over it.
             cxx::Block b;
             b.setEnsureBracesforBlock();
             b.addTmp(cxx::declaration::Local{.id = "__seq", .type = "auto", .init = seq});
-            b.addForRange(true, id, fmt("hilti::rt::range(__seq)"), body);
+            b.addForRange(true, id, fmt("hilti::rt::%s(__seq)", (unsafe ? "unsafe_range" : "range")), body);
             block->addBlock(std::move(b));
         }
     }
@@ -1,5 +1,6 @@
 // Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
 
+#include <optional>
 #include <utility>
 
 #include <hilti/ast/detail/visitor.h>
@@ -17,22 +18,33 @@ using namespace hilti::detail;
 namespace {
 
 struct Visitor : hilti::visitor::PreOrder<std::string, Visitor> {
-    Visitor(CodeGen* cg, cxx::Expression data, const std::vector<cxx::Expression>& args)
-        : cg(cg), data(std::move(data)), args(args) {}
+    Visitor(CodeGen* cg, cxx::Expression data, const std::vector<cxx::Expression>& args,
+            std::optional<ID> byte_order = {})
+        : cg(cg), data(std::move(data)), args(args), byte_order(std::move(byte_order)) {}
     CodeGen* cg;
     cxx::Expression data;
     const std::vector<cxx::Expression>& args;
+    std::optional<ID> byte_order; // Set if the byte order is known at compile time.
+
+    result_t unpackInteger(const char* sign, int width) {
+        if ( byte_order )
+            // Let the C++ compiler specialize the code for the byte order.
+            return fmt("hilti::rt::integer::unpack<%sint%d_t, hilti::rt::ByteOrder::%s>(%s)", sign, width,
+                       *byte_order, data);
+
+        return fmt("hilti::rt::integer::unpack<%sint%d_t>(%s, %s)", sign, width, data, args[0]);
+    }
 
     result_t operator()(const type::Address& n) {
         return fmt("hilti::rt::address::unpack(%s, %s, %s)", data, args[0], args[1]);
     }
 
     result_t operator()(const type::UnsignedInteger& n) {
-        return fmt("hilti::rt::integer::unpack<uint%d_t>(%s, %s)", n.width(), data, args[0]);
+        return unpackInteger("u", n.width());
     }
 
     result_t operator()(const type::SignedInteger& n) {
-        return fmt("hilti::rt::integer::unpack<int%d_t>(%s, %s)", n.width(), data, args[0]);
+        return unpackInteger("", n.width());
     }
 
     result_t operator()(const type::Real& n) {
@@ -44,7 +56,16 @@ struct Visitor : hilti::visitor::PreOrder<std::string, Visitor> {
 
 cxx::Expression CodeGen::unpack(const hilti::Type& t, const Expression& data, const std::vector<Expression>& args) {
     auto cxx_args = util::transform(args, [&](const auto& e) { return compile(e, false); });
-    if ( auto x = Visitor(this, compile(data), cxx_args).dispatch(t) )
+
+    std::optional<ID> byte_order;
+
+    if ( (t.isA<type::UnsignedInteger>() || t.isA<type::SignedInteger>()) && args.size() ) {
+        if ( auto l = expression::constantEnumLabel(args[0]);
+             l && (*l == ID("Little") || *l == ID("Big") || *l == ID("Network") || *l == ID("Host")) )
+            byte_order = std::move(l);
+    }
+
+    if ( auto x = Visitor(this, compile(data), cxx_args, std::move(byte_order)).dispatch(t) )
         return cxx::Expression(*x);
 
     logger().internalError("unpack failed to compile", t);
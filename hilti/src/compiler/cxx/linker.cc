@@ -62,39 +62,61 @@ void cxx::Linker::finalize() {
         }
     }
 
+    // Counts of hooks that we could dispatch without going through a chain
+    // of implementations.
+    unsigned int hooks_empty = 0;
+    unsigned int hooks_direct = 0;
+
     for ( const auto& j : _joins ) {
         auto impl = cxx::Function();
-        auto body = cxx::Block();
-
-        bool first = true;
-        for ( const auto& c : j.second ) {
-            if ( first ) {
-                impl.declaration = c.callee;
-                impl.declaration.id = c.id;
-                first = false;
-            }
+        impl.declaration = j.second.front().callee;
+        impl.declaration.id = j.second.front().id;
+
+        auto callees = util::filter(j.second, [](const auto& c) { return ! c.declare_only; });
+        auto args = util::transform(impl.declaration.args, [](auto& a) { return a.id; });
+        auto has_result = (std::string(impl.declaration.result) != "void");
+
+        if ( callees.empty() ) {
+            // Nothing to call. We don't generate a stub at all, so that call
+            // sites resolve to the empty default implementation their own
+            // unit provides, see `cxx::Unit::add(const linker::Join&)`.
+            ++hooks_empty;
+            continue;
+        }
 
-            if ( c.declare_only )
-                continue;
+        if ( callees.size() == 1 ) {
+            // Forward directly to the single implementation, without
+            // inspecting its result.
+            ++hooks_direct;
 
-            auto args = util::transform(impl.declaration.args, [](auto& a) { return a.id; });
+            auto call = fmt("%s(%s)", callees.front().callee.id, util::join(args, ", "));
+            impl.body.addStatement(has_result ? fmt("return %s", call) : call);
+        }
 
-            if ( std::string(c.callee.result) != "void" ) {
-                cxx::Block done_body;
-                done_body.addStatement("return x;");
-                impl.body.addIf(fmt("auto x = %s(%s)", c.callee.id, util::join(args, ", ")), std::move(done_body));
+        else {
+            for ( const auto& c : callees ) {
+                if ( has_result ) {
+                    cxx::Block done_body;
+                    done_body.addStatement("return x;");
+                    impl.body.addIf(fmt("auto x = %s(%s)", c.callee.id, util::join(args, ", ")),
+                                    std::move(done_body));
+                }
+                else
+                    impl.body.addStatement(fmt("%s(%s)", c.callee.id, util::join(args, ", ")));
             }
-            else
-                impl.body.addStatement(fmt("%s(%s)", c.callee.id, util::join(args, ", ")));
-        }
 
-        if ( std::string(impl.declaration.result) != "void" )
-            impl.body.addStatement("return {}");
+            if ( has_result )
+                impl.body.addStatement("return {}");
+        }
 
         unit.add(impl.declaration);
         unit.add(impl);
     }
 
+    HILTI_DEBUG(logging::debug::Compiler,
+                fmt("  - %u hooks, %u without implementation (calls dropped), %u with a single implementation",
+                    _joins.size(), hooks_empty, hooks_direct));
+
     unsigned int cnt = 0;
     for ( auto g : _globals ) {
         g.init = fmt("%u", cnt++);
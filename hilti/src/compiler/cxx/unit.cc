@@ -124,8 +124,20 @@ void Unit::add(const linker::Join& f) {
     auto d = f.callee;
     d.id = f.id;
     d.linkage = "extern";
+    d.attribute = "__attribute__((weak))";
     add(d);
 
+    // Provide a default implementation that does nothing. If there are
+    // implementations to join, the linker generates a strong version that
+    // takes precedence; otherwise this one remains, and calls to it can be
+    // optimized away.
+    auto body = cxx::Block();
+
+    if ( std::string(d.result) != "void" )
+        body.addStatement("return {}");
+
+    add(cxx::Function{.declaration = d, .body = std::move(body)});
+
     _linker_joins.insert(f);
 }
 
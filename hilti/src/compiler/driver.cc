@@ -25,6 +25,7 @@ static struct option long_driver_options[] = {{"abort-on-exceptions", required_a
                                               {"debug", no_argument, nullptr, 'd'},
                                               {"debug-addl", required_argument, nullptr, 'X'},
                                               {"dump-code", no_argument, nullptr, 'C'},
+                                              {"enable-profiling", no_argument, nullptr, 'Z'},
                                               {"help", no_argument, nullptr, 'h'},
                                               {"include-linker", no_argument, nullptr, 'K'},
                                               {"keep-tmps", no_argument, nullptr, 'T'},
@@ -102,6 +103,8 @@ void Driver::usage() {
            "  -V | --skip-validation          Don't validate ASTs (for debugging only).\n"
            "  -X | --debug-addl <addl>        Implies -d and adds selected additional instrumentation "
            "(comma-separated; see 'help' for list).\n"
+           "  -Z | --enable-profiling         Instrument generated code for profiling, reporting results when "
+           "finishing execution.\n"
            "\n"
            "Inputs can be "
         << exts
@@ -219,7 +222,7 @@ Result<Nothing> Driver::parseOptions(int argc, char** argv) {
     opterr = 0; // don't print errors
 
     while ( true ) {
-        int c = getopt_long(argc, argv, "ABlKL:OcCpPvjJhvVdX:o:D:TEeSR", long_driver_options, nullptr);
+        int c = getopt_long(argc, argv, "ABlKL:OcCpPvjJhvVdX:o:D:TEeSRZ", long_driver_options, nullptr);
 
         if ( c < 0 )
             break;
@@ -340,6 +343,8 @@ Result<Nothing> Driver::parseOptions(int argc, char** argv) {
 
             case 'V': _compiler_options.skip_validation = true; break;
 
+            case 'Z': _compiler_options.enable_profiling = true; break;
+
             case 'h': usage(); return Nothing();
             case '?': usage(); return error("unknown option");
             default: usage(); return error(fmt("option %c not implemented", c));
@@ -899,6 +904,9 @@ Result<Nothing> Driver::finishRuntime() {
     util::timing::Collector _("hilti/runtime/finish");
 
     if ( _runtime_initialized ) {
+        if ( _compiler_options.enable_profiling )
+            rt::profiler::report(std::cerr);
+
         HILTI_DEBUG(logging::debug::Driver, "shutting down runtime");
         hookFinishRuntime();
         rt::done();
@@ -5,13 +5,19 @@
 #undef _FORTIFY_SOURCE
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include <hilti/rt/autogen/config.h>
 
+#include <hilti/rt/configuration.h>
 #include <hilti/rt/context.h>
 #include <hilti/rt/exception.h>
 #include <hilti/rt/fiber.h>
 #include <hilti/rt/global-state.h>
 #include <hilti/rt/logging.h>
+#include <hilti/rt/profiler.h>
 #include <hilti/rt/util.h>
 
 #ifdef HILTI_HAVE_SANITIZER
@@ -22,51 +28,165 @@ using namespace hilti::rt;
 using namespace hilti::rt::detail;
 
 static const unsigned int StackSize = 327680;
+static const unsigned int SharedStackSize = 1048576;
+static const unsigned int SwitcherStackSize = 65536;
 static const unsigned int CacheSize = 100;
 
+// Extra space below a fiber's lowest frame that we save along with it.
+static const unsigned int SavedStackMargin = 128;
+
 const void* _main_thread_bottom = nullptr;
 std::size_t _main_thread_size = 0;
 
-extern "C" {
+// Returns an address located below the stack frame of the calling function.
+static __attribute__((noinline)) const char* _stackPointer() {
+    return static_cast<const char*>(__builtin_frame_address(0));
+}
 
-void _Trampoline(unsigned int y, unsigned int x) {
-    // Magic from from libtask/task.c to turn the two words back into a pointer.
+static bool _useSharedStack() {
+#ifdef HILTI_HAVE_SANITIZER
+    // The sanitizer cannot follow stack content being copied around.
+    return false;
+#else
+    auto cfg = globalState()->configuration.get();
+    return cfg && cfg->fiber_shared_stack;
+#endif
+}
+
+// Magic from from libtask/task.c to turn a pointer into two words.
+// TODO(robin): Probably not portable ...
+static std::pair<unsigned int, unsigned int> _splitPointer(void* p) {
+    unsigned long z = (unsigned long)p; // NOLINT
+    unsigned int y = z;
+    z >>= 16U;
+    unsigned int x = (z >> 16U);
+    return std::make_pair(y, x);
+}
+
+// Magic from from libtask/task.c to turn the two words back into a pointer.
+static void* _joinPointer(unsigned int y, unsigned int x) {
     unsigned long z; // NOLINT
     z = (x << 16U);
     z <<= 16U;
     z |= y;
-    auto fiber = (Fiber*)z; // NOLINT
+    return (void*)z; // NOLINT
+}
+
+extern "C" {
+
+void _Trampoline(unsigned int y, unsigned int x) {
+    auto fiber = static_cast<Fiber*>(_joinPointer(y, x));
 
     fiber->_finishSwitchFiber("trampoline-init");
 
-    // Via recycling a fiber can run an arbitrary number of user jobs. So
-    // this trampoline is really a loop that yields after it has finished its
-    // function, and expects a new run function once it's resumed.
+    // Via recycling a fiber can run an arbitrary number of user jobs. Each
+    // of them starts over from here with a fresh context (see
+    // `Fiber::run()`), so once the function has finished, we never come
+    // back to this frame.
 
-    while ( true ) {
-        assert(fiber->_state == Fiber::State::Running);
+    assert(fiber->_state == Fiber::State::Running);
 
-        if ( ! _setjmp(fiber->_trampoline) ) {
-            // In parent.
-            try {
-                fiber->_result = (*fiber->_function)(fiber);
-            } catch ( ... ) {
-                HILTI_RT_DEBUG("fibers", fmt("[%p] got exception, forwarding", fiber));
-                fiber->_exception = std::current_exception();
-            }
+    try {
+        fiber->_result = (*fiber->_function)(fiber);
+    } catch ( ... ) {
+        HILTI_RT_DEBUG("fibers", fmt("[%p] got exception, forwarding", fiber));
+        fiber->_exception = std::current_exception();
+    }
 
-            fiber->_state = Fiber::State::Finished;
-        }
+    ++Fiber::_total_functions;
+
+    if ( fiber->_yields > Fiber::_max_yields )
+        Fiber::_max_yields = fiber->_yields;
+
+    fiber->_function = {};
+    fiber->_state = Fiber::State::Idle;
 
-        if ( ! _setjmp(fiber->_fiber) ) {
-            fiber->_function = {};
-            fiber->_state = Fiber::State::Idle;
-            fiber->_startSwitchFiber("trampoline");
-            _longjmp(fiber->_parent, 1);
+    if ( fiber->_shared ) {
+        // Our frames won't be needed anymore, no need to save them. Fibers
+        // anchored to us will notice as well.
+        globalState()->shared_stack->owner = nullptr;
+        fiber->_job.reset();
+    }
+
+    fiber->_startSwitchFiber("trampoline");
+    Fiber::_switchTo((fiber->_caller ? fiber->_caller->_anchor : nullptr), &fiber->_parent);
+}
+
+static void _SwitchTrampoline(unsigned int y, unsigned int x) {
+    static_cast<SharedStack*>(_joinPointer(y, x))->runSwitcher();
+}
+}
+
+SharedStack::SharedStack() {
+    HILTI_RT_DEBUG("fibers", "allocating shared stack");
+
+    size = SharedStackSize;
+    bottom = new char[size];
+    switcher_stack = new char[SwitcherStackSize];
+
+    if ( getcontext(&switcher) < 0 )
+        internalError("fiber: getcontext failed");
+
+    switcher.uc_link = nullptr;
+    switcher.uc_stack.ss_size = SwitcherStackSize;
+    switcher.uc_stack.ss_sp = switcher_stack;
+    switcher.uc_stack.ss_flags = 0;
+
+    auto [y, x] = _splitPointer(this);
+    makecontext(&switcher, (void (*)())_SwitchTrampoline, 2, y, x); // NOLINT (cppcoreguidelines-pro-type-cstyle-cast)
+
+    // Let the switcher set itself up, it will come right back.
+    if ( ! _setjmp(switcher_init) )
+        setcontext(&switcher);
+}
+
+SharedStack::~SharedStack() {
+    HILTI_RT_DEBUG("fibers", "deleting shared stack");
+
+    delete[] bottom;
+    delete[] switcher_stack;
+}
+
+void SharedStack::prepare(Fiber* f, bool fresh) {
+    if ( owner == f )
+        return;
+
+    auto top = bottom + size;
+
+    if ( owner ) {
+        auto from = std::max(static_cast<const char*>(bottom), owner_sp - SavedStackMargin);
+        auto n = static_cast<size_t>(top - from);
+        auto& saved = owner->_saved;
+
+        if ( saved.capacity < n ) {
+            Fiber::_saved_bytes += (n - saved.capacity);
+            saved.data = std::unique_ptr<char[]>(new char[n]); // NOLINT (modernize-make-unique) no need to initialize
+            saved.capacity = n;
         }
 
-        fiber->_finishSwitchFiber("trampoline-loop");
+        HILTI_RT_DEBUG("fibers", fmt("[%p] saving %zu bytes of shared stack", owner, n));
+        memcpy(saved.data.get(), from, n);
+        saved.size = n;
+        ++Fiber::_stack_copies;
+    }
+
+    if ( f && ! fresh ) {
+        auto& saved = f->_saved;
+        HILTI_RT_DEBUG("fibers", fmt("[%p] restoring %zu bytes of shared stack", f, saved.size));
+        memcpy(top - saved.size, saved.data.get(), saved.size);
+        ++Fiber::_stack_copies;
     }
+
+    owner = f;
+}
+
+void SharedStack::runSwitcher() {
+    if ( ! _setjmp(switcher_loop) )
+        _longjmp(switcher_init, 1);
+
+    // We get here each time a switch needs our help, running on our own
+    // stack now so that the shared one can be modified.
+    Fiber::_switchTo(pending_owner, pending_target, pending_start);
 }
 
 Fiber::Fiber() {
@@ -76,54 +196,141 @@ Fiber::Fiber() {
         internalError("fiber: getcontext failed");
 
     _uctx.uc_link = nullptr;
-    _uctx.uc_stack.ss_size = StackSize;
-    _uctx.uc_stack.ss_sp = new char[StackSize];
     _uctx.uc_stack.ss_flags = 0;
 
-    // Magic from from libtask/task.c to turn the pointer into two words.
-    // TODO(robin): Probably not portable ...
-    unsigned long z = (unsigned long)this; // NOLINT
-    unsigned int y = z;
-    z >>= 16U;
-    unsigned int x = (z >> 16U);
-
-    makecontext(&_uctx, (void (*)())_Trampoline, 2, y, x); // NOLINT (cppcoreguidelines-pro-type-cstyle-cast)
-
     ++_total_fibers;
     ++_current_fibers;
 
     if ( _current_fibers > _max_fibers )
         _max_fibers = _current_fibers;
 }
-}
 
 class AbortException : public std::exception {};
 
 Fiber::~Fiber() {
     HILTI_RT_DEBUG("fibers", fmt("deleting fiber %p", this));
 
-    delete[] static_cast<char*>(_uctx.uc_stack.ss_sp);
+    if ( __global_state && __global_state->shared_stack && __global_state->shared_stack->owner == this )
+        __global_state->shared_stack->owner = nullptr;
+
+    if ( _stack ) {
+        delete[] _stack;
+        --_individual_stacks;
+    }
+
+    _saved_bytes -= _saved.capacity;
     --_current_fibers;
 }
 
+void Fiber::_switchTo(Fiber* owner, jmp_buf* target, Fiber* start) {
+    if ( owner ) {
+        auto ss = globalState()->shared_stack.get();
+
+        if ( ss->owner != owner ) {
+            if ( ss->contains(_stackPointer()) ) {
+                // We can't modify the shared stack while executing on it,
+                // so let the switcher take over from its own stack.
+                ss->pending_owner = owner;
+                ss->pending_target = target;
+                ss->pending_start = start;
+                _longjmp(ss->switcher_loop, 1);
+            }
+
+            ss->prepare(owner, (! target && owner == start));
+        }
+    }
+
+    if ( target )
+        _longjmp(*target, 1);
+
+    // Start the fiber from scratch. Note that this writes to the top of its
+    // stack, so we can do this only once the shared stack is ready for it.
+    auto [y, x] = _splitPointer(start);
+    makecontext(&start->_uctx, (void (*)())_Trampoline, 2, y, x); // NOLINT (cppcoreguidelines-pro-type-cstyle-cast)
+    setcontext(&start->_uctx);
+
+    internalError("fiber: unreachable reached");
+}
+
+void Fiber::_anchorTo(Fiber* anchor) {
+    _anchor = anchor;
+
+    if ( anchor && anchor != this ) {
+        if ( ! anchor->_job )
+            anchor->_job = std::make_shared<bool>(true);
+
+        _anchor_job = anchor->_job;
+    }
+    else
+        _anchor_job.reset();
+}
+
 void Fiber::run() {
-    auto init = (_state == State::Init);
+    // A fiber reused from the cache starts over from scratch, too. Its
+    // placement may differ from before if it's now running inside another
+    // fiber, or no longer is.
+    auto init = (_state == State::Init || _state == State::Idle);
+
+    if ( init ) {
+        // Fibers started from inside other fibers get individual stacks,
+        // as they may be referencing their parent's frames. For the same
+        // reason, they need the frames of the closest fiber up their chain
+        // that's running on the shared stack to be in place while
+        // executing.
+        _shared = (! _current && _useSharedStack());
+        _anchorTo(_shared ? this : (_current ? _current->_anchor : nullptr));
+
+        if ( _shared ) {
+            auto& ss = globalState()->shared_stack;
+
+            if ( ! ss )
+                ss = std::make_unique<SharedStack>();
+
+            _uctx.uc_stack.ss_sp = ss->bottom;
+            _uctx.uc_stack.ss_size = ss->size;
+        }
+        else {
+            if ( ! _stack ) {
+                _stack = new char[StackSize];
+                ++_individual_stacks;
+            }
+
+            _uctx.uc_stack.ss_sp = _stack;
+            _uctx.uc_stack.ss_size = StackSize;
+        }
+    }
+
+    else if ( _anchor && _anchor != this && _anchor_job.expired() )
+        // The fiber we were started from has finished its job since, so its
+        // frames are gone and we can't depend on them anymore. Continue with
+        // what our new caller needs in place instead.
+        _anchorTo(_current ? _current->_anchor : nullptr);
 
     if ( _state != State::Aborting )
         _state = State::Running;
 
+    ++_total_switches;
+
+    // If we're called from a fiber on the shared stack, record how much of
+    // it is in use in case it needs to be saved away.
+    if ( auto ss = globalState()->shared_stack.get() ) {
+        if ( auto sp = _stackPointer(); ss->contains(sp) )
+            ss->owner_sp = sp;
+    }
+
+    _caller = _current;
+    _current = this;
+
     if ( ! _setjmp(_parent) ) {
         _startSwitchFiber("run", _uctx.uc_stack.ss_sp, _uctx.uc_stack.ss_size);
 
         if ( init )
-            setcontext(&_uctx);
-        else {
-            _longjmp(_fiber, 1);
-        }
-
-        internalError("fiber: unreachable reached");
+            _switchTo(_anchor, nullptr, this);
+        else
+            _switchTo(_anchor, &_fiber);
     }
 
+    _current = _caller;
     _finishSwitchFiber("run");
 
     switch ( _state ) {
@@ -137,14 +344,24 @@ void Fiber::run() {
 void Fiber::yield() {
     assert(_state == State::Running);
 
+    ++_yields;
+    ++_total_yields;
+    const uint64_t suspended_at = (profiler::detail::isActive() ? profiler::detail::now() : 0);
+
+    if ( _shared )
+        globalState()->shared_stack->owner_sp = _stackPointer();
+
     if ( ! _setjmp(_fiber) ) {
         _state = State::Yielded;
         _startSwitchFiber("yield");
-        _longjmp(_parent, 1);
+        _switchTo((_caller ? _caller->_anchor : nullptr), &_parent);
     }
 
     _finishSwitchFiber("yield");
 
+    if ( suspended_at )
+        _suspended += profiler::detail::now() - suspended_at;
+
     if ( _state == State::Aborting )
         throw AbortException();
 }
@@ -187,6 +404,12 @@ void Fiber::reset() {
     _total_fibers = 0;
     _current_fibers = 0;
     _max_fibers = 0;
+    _total_switches = 0;
+    _total_functions = 0;
+    _total_yields = 0;
+    _max_yields = 0;
+    _total_direct = 0;
+    _stack_copies = 0;
 }
 
 void Fiber::_startSwitchFiber(const char* tag, const void* stack_bottom, size_t stack_size) {
@@ -267,6 +490,13 @@ void Resumable::yielded() {
     }
 }
 
+DirectExecution::DirectExecution() : _old(context::detail::get()->resumable) {
+    context::detail::get()->resumable = nullptr;
+    ++Fiber::_total_direct;
+}
+
+DirectExecution::~DirectExecution() { context::detail::get()->resumable = _old; }
+
 void detail::yield() {
     auto r = context::detail::get()->resumable;
 
@@ -278,10 +508,23 @@ void detail::yield() {
 }
 
 Fiber::Statistics Fiber::statistics() {
+    uint64_t stack_bytes = _individual_stacks * StackSize + _saved_bytes;
+
+    if ( globalState()->shared_stack )
+        stack_bytes += SharedStackSize + SwitcherStackSize;
+
     Statistics stats{.total = _total_fibers,
                      .current = _current_fibers,
                      .cached = globalState()->fiber_cache.size(),
-                     .max = _max_fibers};
+                     .max = _max_fibers,
+                     .stack_size = StackSize,
+                     .stack_bytes = stack_bytes,
+                     .stack_copies = _stack_copies,
+                     .switches = _total_switches,
+                     .functions = _total_functions,
+                     .yields = _total_yields,
+                     .max_yields = _max_yields,
+                     .direct = _total_direct};
 
     return stats;
 }
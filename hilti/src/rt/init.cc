@@ -31,6 +31,8 @@ void hilti::rt::init() {
 
     HILTI_RT_DEBUG("libhilti", "initializing runtime");
 
+    debug::setLocation();
+
     globalState()->master_context = std::make_unique<Context>(vthread::Master);
     context::detail::set(globalState()->master_context.get());
 
@@ -57,6 +59,9 @@ void hilti::rt::done() {
 
     HILTI_RT_DEBUG("libhilti", "shutting down runtime");
 
+    // The location may point into a library that's about to be unloaded.
+    debug::setLocation();
+
     delete __global_state; // NOLINT (cppcoreguidelines-owning-memory)
     __global_state = nullptr;
 }
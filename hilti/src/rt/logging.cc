@@ -14,6 +14,10 @@ using namespace hilti::rt::detail;
 
 using namespace hilti::rt;
 
+static thread_local const char* _current_location = nullptr;
+
+const char*& debug::detail::current_location() { return _current_location; }
+
 void hilti::rt::internalError(const std::string& msg) {
     std::cerr << fmt("[libhilti] Internal error: %s", msg) << std::endl;
     abort_with_backtrace();
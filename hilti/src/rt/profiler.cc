@@ -0,0 +1,104 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <vector>
+
+#include <hilti/rt/context.h>
+#include <hilti/rt/fiber.h>
+#include <hilti/rt/fmt.h>
+#include <hilti/rt/global-state.h>
+#include <hilti/rt/profiler.h>
+
+using namespace hilti::rt;
+
+uint64_t profiler::detail::now() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+}
+
+Profiler profiler::start(const std::string& name, uint64_t volume) {
+    Profiler p;
+    p._measurement = &::hilti::rt::detail::globalState()->profilers[name];
+    p._volume = volume;
+
+    if ( auto r = context::detail::get()->resumable ) {
+        p._suspended = r->suspendedTime();
+        p._yields = r->yields();
+    }
+
+    p._time = detail::now();
+    return p;
+}
+
+void profiler::stop(const Profiler& p, uint64_t volume) {
+    auto t = detail::now();
+
+    if ( ! p._measurement )
+        return;
+
+    auto elapsed = t - p._time;
+    uint64_t yields = 0;
+
+    if ( auto r = context::detail::get()->resumable; r && r->yields() >= p._yields ) {
+        // Don't count the time we spent suspended.
+        elapsed -= std::min(elapsed, r->suspendedTime() - p._suspended);
+        yields = r->yields() - p._yields;
+    }
+
+    auto m = p._measurement;
+    m->count += 1;
+    m->time += elapsed;
+    m->yields += yields;
+
+    if ( volume >= p._volume )
+        m->volume += (volume - p._volume);
+}
+
+std::optional<profiler::Measurement> profiler::get(const std::string& name) {
+    const auto& profilers = ::hilti::rt::detail::globalState()->profilers;
+
+    if ( auto i = profilers.find(name); i != profilers.end() && i->second.count )
+        return i->second;
+
+    return {};
+}
+
+std::map<std::string, profiler::Measurement> profiler::all() {
+    std::map<std::string, Measurement> result;
+
+    for ( const auto& [name, m] : ::hilti::rt::detail::globalState()->profilers ) {
+        if ( m.count )
+            result.emplace(name, m);
+    }
+
+    return result;
+}
+
+void profiler::reset() {
+    // We keep the entries themselves as running profilers may still be
+    // pointing to them.
+    for ( auto& [name, m] : ::hilti::rt::detail::globalState()->profilers )
+        m = Measurement();
+}
+
+void profiler::report(std::ostream& out) {
+    auto measurements = all();
+
+    if ( measurements.empty() )
+        return;
+
+    std::vector<std::pair<std::string, Measurement>> sorted(measurements.begin(), measurements.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto& x, const auto& y) { return x.second.time > y.second.time; });
+
+    out << "\n=== Profiling Summary ===\n\n";
+    out << fmt("%10s %12s %12s %12s %8s   %s\n", "count", "time/s", "avg-time/us", "volume", "yields", "name");
+
+    for ( const auto& [name, m] : sorted )
+        out << fmt("%10" PRIu64 " %12.6f %12.3f %12" PRIu64 " %8" PRIu64 "   %s\n", m.count, m.time / 1e9,
+                   m.time / 1e3 / m.count, m.volume, m.yields, name);
+
+    out << std::endl;
+}
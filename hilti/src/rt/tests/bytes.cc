@@ -45,6 +45,7 @@ TEST_CASE("construct") {
 
     CHECK_EQ(Bytes("\xF0\x9F\x98\x85", bytes::Charset::UTF8).str(), "\xF0\x9F\x98\x85");
     CHECK_EQ(Bytes("\xF0\x9F\x98\x85", bytes::Charset::ASCII).str(), "????");
+    CHECK_EQ(Bytes("0123456789abcdef\t0123456789", bytes::Charset::ASCII).str(), "0123456789abcdef?0123456789");
 
     CHECK_THROWS_WITH_AS(Bytes("123", bytes::Charset::Undef), "unknown character set for encoding",
                          const RuntimeError&);
@@ -56,6 +57,8 @@ TEST_CASE("decode") {
     CHECK_EQ("abc"_b.decode(bytes::Charset::UTF8), "abc");
     CHECK_EQ("\xF0\x9F\x98\x85"_b.decode(bytes::Charset::UTF8), "\xF0\x9F\x98\x85");
     CHECK_EQ("\xF0\x9F\x98\x85"_b.decode(bytes::Charset::ASCII), "\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd");
+    CHECK_EQ("Host: www.example.com\r\n"_b.decode(bytes::Charset::ASCII), "Host: www.example.com\ufffd\ufffd");
+    CHECK_EQ("0123456789\x00" "abcdef0123456789"_b.decode(bytes::Charset::ASCII), "0123456789\ufffdabcdef0123456789");
 
     CHECK_THROWS_WITH_AS("123"_b.decode(bytes::Charset::Undef), "unknown character set for decoding",
                          const RuntimeError&);
@@ -0,0 +1,47 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <thread>
+
+#include <hilti/rt/exception.h>
+#include <hilti/rt/logging.h>
+
+using namespace hilti::rt;
+
+TEST_SUITE_BEGIN("Exception");
+
+TEST_CASE("location") {
+    __location__("foo.hlt:1:2");
+    CHECK_EQ(std::string(debug::location()), "foo.hlt:1:2");
+
+    auto e = RuntimeError("my error");
+    CHECK_EQ(e.description(), "my error");
+    CHECK_EQ(e.location(), "foo.hlt:1:2");
+    CHECK_EQ(std::string(e.what()), "my error (foo.hlt:1:2)");
+
+    debug::setLocation();
+    CHECK_EQ(debug::location(), nullptr);
+
+    auto e2 = RuntimeError("my error");
+    CHECK_EQ(e2.location(), "");
+    CHECK_EQ(std::string(e2.what()), "my error");
+}
+
+TEST_CASE("location per thread") {
+    __location__("main.hlt:1:2");
+
+    std::thread t([]() {
+        CHECK_EQ(debug::location(), nullptr);
+        __location__("thread.hlt:3:4");
+        CHECK_EQ(std::string(debug::location()), "thread.hlt:3:4");
+    });
+
+    t.join();
+    CHECK_EQ(std::string(debug::location()), "main.hlt:1:2");
+
+    debug::setLocation();
+}
+
+TEST_SUITE_END();
@@ -2,10 +2,18 @@
 
 #include <doctest/doctest.h>
 
+#include <array>
 #include <exception>
+#include <numeric>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <vector>
 
+#include <hilti/rt/configuration.h>
+#include <hilti/rt/exception.h>
 #include <hilti/rt/fiber.h>
+#include <hilti/rt/global-state.h>
 #include <hilti/rt/init.h>
 
 class TestDtor { //NOLINT
@@ -15,6 +23,24 @@ public:
     std::string& c;
 };
 
+// Enables the shared fiber stack for the lifetime of the instance. The
+// configuration can't be changed anymore once the runtime has been
+// initialized, so we flip the setting directly.
+class SharedStack { //NOLINT
+public:
+    SharedStack() {
+        hilti::rt::configuration::get(); // make sure it exists
+        auto& cfg = hilti::rt::detail::globalState()->configuration;
+        _old = cfg->fiber_shared_stack;
+        cfg->fiber_shared_stack = true;
+    }
+
+    ~SharedStack() { hilti::rt::detail::globalState()->configuration->fiber_shared_stack = _old; }
+
+private:
+    bool _old;
+};
+
 
 TEST_SUITE_BEGIN("fiber");
 
@@ -199,6 +225,10 @@ TEST_CASE("stats") {
     REQUIRE(stats.current == 2);
     REQUIRE(stats.cached == 1);
     REQUIRE(stats.max == 2);
+    REQUIRE(stats.switches == 5);
+    REQUIRE(stats.functions == 2);
+    REQUIRE(stats.yields == 3);
+    REQUIRE(stats.max_yields == 1);
 
     r3.resume();
     REQUIRE(r3);
@@ -208,6 +238,298 @@ TEST_CASE("stats") {
     REQUIRE(stats.current == 2);
     REQUIRE(stats.cached == 2);
     REQUIRE(stats.max == 2);
+    REQUIRE(stats.switches == 6);
+    REQUIRE(stats.functions == 3);
+    REQUIRE(stats.yields == 3);
+    REQUIRE(stats.max_yields == 1);
+}
+
+TEST_CASE("direct") {
+    hilti::rt::detail::Fiber::reset(); // reset cache and counters
+
+    std::string c;
+
+    auto f = [&](hilti::rt::resumable::Handle* r) {
+        TestDtor t(c);
+        return std::string("Hello directly!");
+    };
+
+    auto r = hilti::rt::Resumable::direct(f);
+    REQUIRE(r);
+    REQUIRE(r.get<std::string>() == "Hello directly!");
+    REQUIRE(c == "ctordtor");
+
+    // Yielding isn't possible without a fiber, even when running inside one.
+    auto g = [](hilti::rt::resumable::Handle* r) { hilti::rt::detail::yield(); };
+    CHECK_THROWS_WITH_AS(hilti::rt::Resumable::direct(g), "'yield' in non-suspendable context",
+                         const hilti::rt::Exception&);
+
+    auto outer = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        CHECK_THROWS_AS(hilti::rt::Resumable::direct(g), const hilti::rt::Exception&);
+        hilti::rt::detail::yield();
+    });
+
+    REQUIRE(! outer);
+    outer.resume();
+    REQUIRE(outer);
+
+    auto stats = hilti::rt::detail::Fiber::statistics();
+    REQUIRE(stats.total == 1);
+    REQUIRE(stats.functions == 1);
+    REQUIRE(stats.yields == 1);
+    REQUIRE(stats.direct == 3);
+}
+
+TEST_CASE("shared-stack") {
+    SharedStack ss;
+    hilti::rt::detail::Fiber::reset(); // reset cache and counters
+
+    // Interleave a set of fibers that keep state on the stack, which needs
+    // to survive switching between them.
+    auto f = [](hilti::rt::resumable::Handle* r) {
+        std::array<uint64_t, 512> x{};
+
+        for ( auto i = 0U; i < x.size(); i++ ) {
+            x[i] = i;
+
+            if ( i % 128 == 0 )
+                r->yield();
+        }
+
+        return std::accumulate(x.begin(), x.end(), uint64_t(0));
+    };
+
+    std::vector<hilti::rt::Resumable> rs;
+
+    for ( auto i = 0; i < 10; i++ )
+        rs.push_back(hilti::rt::fiber::execute(f));
+
+    for ( auto round = 0; round < 4; round++ ) {
+        for ( auto& r : rs ) {
+            REQUIRE(! r);
+            r.resume();
+        }
+    }
+
+    for ( auto& r : rs ) {
+        REQUIRE(r);
+        CHECK(r.get<uint64_t>() == 512 * 511 / 2);
+    }
+
+    auto stats = hilti::rt::detail::Fiber::statistics();
+    CHECK(stats.stack_copies > 0);
+    CHECK(stats.stack_bytes > 0);
+}
+
+TEST_CASE("shared-stack-nested") {
+    SharedStack ss;
+    std::string x;
+
+    // Top-level fiber that will be resumed from inside other fibers.
+    auto t = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::string local = "t";
+        x += local + "1";
+        r->yield();
+        x += local + "2";
+        r->yield();
+        x += local + "3";
+    });
+
+    REQUIRE(! t);
+
+    auto a = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::string local = "a";
+
+        // Nested fiber, it gets an individual stack.
+        auto n = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+            x += local + "n1";
+            r->yield();
+            t.resume(); // swaps out our parent
+            x += local + "n2";
+        });
+
+        x += local + "1";
+        r->yield();
+
+        n.resume();
+        REQUIRE(n);
+        x += local + "2";
+
+        t.resume(); // runs on the shared stack just like us
+        REQUIRE(t);
+        x += local + "3";
+    });
+
+    REQUIRE(! a);
+
+    auto b = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::string local = "b";
+        x += local + "1";
+    });
+
+    REQUIRE(b);
+
+    a.resume();
+    REQUIRE(a);
+    CHECK(x == "t1an1a1b1t2an2a2t3a3");
+}
+
+TEST_CASE("shared-stack-reuse") {
+    SharedStack ss;
+    hilti::rt::detail::Fiber::reset(); // reset cache and counters
+
+    std::string x;
+
+    // Top-level fiber that gets suspended while holding state on the shared stack.
+    auto b = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::array<uint64_t, 256> local{};
+        std::iota(local.begin(), local.end(), 1);
+        r->yield();
+
+        // Reuses the cached fiber from inside us, so it needs our frames in place.
+        auto n = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+            x += "n";
+            r->yield();
+            x += std::to_string(std::accumulate(local.begin(), local.end(), uint64_t(0)));
+        });
+
+        REQUIRE(! n);
+        n.resume();
+        REQUIRE(n);
+
+        return std::accumulate(local.begin(), local.end(), uint64_t(0));
+    });
+
+    REQUIRE(! b);
+
+    // Finishes right away, putting its fiber into the cache.
+    auto a = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) { x += "a"; });
+    REQUIRE(a);
+
+    // Reuses the cached fiber at the top-level while `b` is suspended.
+    auto c = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::array<uint64_t, 256> local{};
+        local.fill(42);
+        r->yield();
+        x += "c";
+        return std::accumulate(local.begin(), local.end(), uint64_t(0));
+    });
+
+    REQUIRE(! c);
+    c.resume();
+    REQUIRE(c);
+    CHECK(c.get<uint64_t>() == 42 * 256);
+
+    b.resume();
+    REQUIRE(b);
+    CHECK(b.get<uint64_t>() == 256 * 257 / 2);
+    CHECK(x == "acn32896");
+
+    auto stats = hilti::rt::detail::Fiber::statistics();
+    CHECK(stats.total == 2);
+    CHECK(stats.functions == 4);
+}
+
+TEST_CASE("shared-stack-nested-outlives-anchor") {
+    SharedStack ss;
+    hilti::rt::detail::Fiber::reset(); // reset cache and counters
+
+    std::string x;
+    std::optional<hilti::rt::Resumable> n;
+
+    // Top-level fiber starting a nested one that's still suspended when we finish.
+    auto a = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::string local = "a";
+        x += local;
+
+        n = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+            std::string local = "n";
+            x += local + "1";
+            r->yield();
+            x += local + "2";
+            r->yield();
+            x += local + "3";
+        });
+
+        REQUIRE(! *n);
+    });
+
+    REQUIRE(a);
+
+    // Reuses the finished fiber from the cache, putting different frames
+    // onto the shared stack.
+    auto b = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::array<uint64_t, 256> local{};
+        local.fill(42);
+        r->yield();
+
+        n->resume(); // from inside another fiber
+        REQUIRE(! *n);
+
+        x += "b";
+        return std::accumulate(local.begin(), local.end(), uint64_t(0));
+    });
+
+    REQUIRE(! b);
+
+    // Drop all cached fibers.
+    hilti::rt::detail::Fiber::reset();
+
+    b.resume();
+    REQUIRE(b);
+    CHECK(b.get<uint64_t>() == 42 * 256);
+
+    n->resume(); // from the top-level
+    REQUIRE(*n);
+    CHECK(x == "an1n2bn3");
+}
+
+TEST_CASE("shared-stack-address-across-yield") {
+    SharedStack ss;
+    hilti::rt::detail::Fiber::reset(); // reset cache and counters
+
+    uint64_t* p = nullptr;
+
+    // Top-level fiber handing out the address of a local that's on the shared stack.
+    auto a = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        uint64_t local = 1;
+        p = &local;
+        r->yield();
+
+        // Writes through the address from a nested fiber while we're suspended.
+        auto n = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+            *p += 10;
+            r->yield();
+            *p += 100;
+        });
+
+        REQUIRE(! n);
+        n.resume();
+        REQUIRE(n);
+
+        return local;
+    });
+
+    REQUIRE(! a);
+    REQUIRE(p);
+
+    // Runs on the same part of the shared stack, overwriting what's there.
+    auto b = hilti::rt::fiber::execute([&](hilti::rt::resumable::Handle* r) {
+        std::array<uint64_t, 256> local{};
+        local.fill(42);
+        r->yield();
+        return std::accumulate(local.begin(), local.end(), uint64_t(0));
+    });
+
+    REQUIRE(! b);
+
+    a.resume();
+    REQUIRE(a);
+    CHECK(a.get<uint64_t>() == 111);
+
+    b.resume();
+    REQUIRE(b);
+    CHECK(b.get<uint64_t>() == 42 * 256);
 }
 
 TEST_SUITE_END();
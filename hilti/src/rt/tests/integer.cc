@@ -0,0 +1,79 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <cstdint>
+#include <tuple>
+
+#include <doctest/doctest.h>
+
+#include <hilti/rt/types/bytes.h>
+#include <hilti/rt/types/integer.h>
+#include <hilti/rt/types/stream.h>
+
+using namespace hilti::rt;
+using namespace hilti::rt::bytes::literals;
+
+TEST_SUITE_BEGIN("Integer");
+
+template<typename T, ByteOrder BO, typename D>
+static void checkUnpack(const D& data) {
+    auto x = integer::unpack<T, BO>(data);
+    auto y = integer::unpack<T>(data, BO);
+    REQUIRE(x);
+    REQUIRE(y);
+    CHECK_EQ(std::get<0>(*x), std::get<0>(*y));
+    CHECK_EQ(std::get<1>(*x), std::get<1>(*y));
+}
+
+template<ByteOrder BO, typename D>
+static void checkUnpackAll(const D& data) {
+    checkUnpack<uint8_t, BO>(data);
+    checkUnpack<int8_t, BO>(data);
+    checkUnpack<uint16_t, BO>(data);
+    checkUnpack<int16_t, BO>(data);
+    checkUnpack<uint32_t, BO>(data);
+    checkUnpack<int32_t, BO>(data);
+    checkUnpack<uint64_t, BO>(data);
+    checkUnpack<int64_t, BO>(data);
+}
+
+TEST_CASE("unpack with constant byte order") {
+    const auto b = "\x81\x02\x03\x04\x05\x06\x07\xf8\x09"_b;
+
+    CHECK_EQ(std::get<0>(*integer::unpack<uint16_t, ByteOrder::Big>(b)), 0x8102U);
+    CHECK_EQ(std::get<0>(*integer::unpack<uint16_t, ByteOrder::Little>(b)), 0x0281U);
+    CHECK_EQ(std::get<0>(*integer::unpack<int8_t, ByteOrder::Network>(b)), -127);
+    CHECK_EQ(std::get<0>(*integer::unpack<uint32_t, ByteOrder::Network>(b)), 0x81020304U);
+    CHECK_EQ(std::get<1>(*integer::unpack<uint32_t, ByteOrder::Network>(b)), "\x05\x06\x07\xf8\x09"_b);
+
+    checkUnpackAll<ByteOrder::Big>(b);
+    checkUnpackAll<ByteOrder::Network>(b);
+    checkUnpackAll<ByteOrder::Little>(b);
+    checkUnpackAll<ByteOrder::Host>(b);
+
+    // Data spanning multiple stream chunks.
+    auto s = Stream("\x81\x02\x03"_b);
+    s.append("\x04\x05\x06\x07\xf8\x09"_b);
+    checkUnpackAll<ByteOrder::Big>(s.view());
+    checkUnpackAll<ByteOrder::Little>(s.view());
+
+    CHECK_FALSE(integer::unpack<uint32_t, ByteOrder::Big>("\x01\x02"_b));
+    CHECK_FALSE(integer::unpack<uint32_t, ByteOrder::Undef>(b));
+}
+
+TEST_CASE("bits") {
+    const auto v = integer::safe<uint8_t>(0xb4); // 1011 0100
+
+    CHECK_EQ(integer::bits(v, 0, 3, integer::BitOrder::LSB0), 0x4U);
+    CHECK_EQ(integer::bits(v, 4, 7, integer::BitOrder::LSB0), 0xbU);
+    CHECK_EQ(integer::bits(v, 2, 2, integer::BitOrder::LSB0), 1U);
+    CHECK_EQ(integer::bits(v, 0, 7, integer::BitOrder::LSB0), 0xb4U);
+    CHECK_EQ(integer::bits(v, 0, 3, integer::BitOrder::MSB0), 0xbU);
+    CHECK_EQ(integer::bits(v, 0, 0, integer::BitOrder::MSB0), 1U);
+
+    const auto w = integer::safe<uint64_t>(0xf000000000000001);
+    CHECK_EQ(integer::bits(w, 0, 63, integer::BitOrder::LSB0), w);
+    CHECK_EQ(integer::bits(w, 32, 63, integer::BitOrder::LSB0), 0xf0000000U);
+    CHECK_EQ(integer::bits(w, 60, 63, integer::BitOrder::LSB0), 0xfU);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,140 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <string>
+#include <tuple>
+
+#include <doctest/doctest.h>
+
+#include <hilti/rt/types/bytes.h>
+#include <hilti/rt/types/literal-set.h>
+#include <hilti/rt/types/stream.h>
+#include <hilti/rt/types/vector.h>
+
+using namespace hilti::rt;
+using namespace hilti::rt::bytes::literals;
+
+TEST_SUITE_BEGIN("LiteralSet");
+
+TEST_CASE("construct") {
+    CHECK_EQ(LiteralSet().size(), 0);
+    CHECK_EQ(LiteralSet(Vector<Bytes>({"abc"_b, "def"_b})).size(), 2);
+    CHECK_THROWS_AS(LiteralSet(Vector<Bytes>({"abc"_b, ""_b})), const InvalidArgument&);
+}
+
+TEST_CASE("find") {
+    const auto s = LiteralSet(Vector<Bytes>({"he"_b, "she"_b, "his"_b, "hers"_b}));
+
+    CHECK_EQ(s.find("ushers"_b), std::make_tuple(2, "she"_b));
+    CHECK_EQ(s.find("xhisx"_b), std::make_tuple(3, "his"_b));
+    CHECK_EQ(s.find("hxexrs"_b), std::make_tuple(0, ""_b));
+    CHECK_EQ(s.find(""_b), std::make_tuple(0, ""_b));
+
+    // The literal ending first wins, even if another one starts earlier.
+    const auto s2 = LiteralSet(Vector<Bytes>({"abcd"_b, "bc"_b}));
+    CHECK_EQ(s2.find("xabcd"_b), std::make_tuple(2, "bc"_b));
+
+    // For the same end, the longest wins; for duplicates, the first.
+    const auto s3 = LiteralSet(Vector<Bytes>({"c"_b, "abc"_b, "bc"_b, "abc"_b}));
+    CHECK_EQ(s3.find("xabcx"_b), std::make_tuple(2, "abc"_b));
+
+    // Shared first byte.
+    const auto s4 = LiteralSet(Vector<Bytes>({"--a"_b, "--b"_b}));
+    CHECK_EQ(s4.find("x-y--c--b"_b), std::make_tuple(2, "--b"_b));
+
+    CHECK_EQ(LiteralSet().find("abc"_b), std::make_tuple(0, ""_b));
+}
+
+TEST_CASE("find binary data") {
+    const auto s = LiteralSet(Vector<Bytes>({"\x00\xff"_b, "\r\n\r\n"_b}));
+    CHECK_EQ(s.find("abc\x00\x01\x00\xff"_b), std::make_tuple(1, "\x00\xff"_b));
+    CHECK_EQ(s.find("GET / HTTP/1.0\r\n\r\nxyz"_b), std::make_tuple(2, "\r\n\r\n"_b));
+}
+
+TEST_CASE("find against naive search") {
+    const auto literals = Vector<Bytes>({"aab"_b, "ab"_b, "bba"_b, "baab"_b, "bbbb"_b, "a"_b});
+    const auto s = LiteralSet(literals);
+
+    std::string data;
+    uint32_t x = 42;
+    for ( int i = 0; i < 200; i++ ) {
+        x = x * 1103515245 + 12345;
+        data.push_back((x >> 16U) % 3 ? 'b' : 'a');
+    }
+
+    for ( size_t start = 0; start < data.size(); start++ ) {
+        // Naive reference: smallest end position, then longest, then first.
+        int32_t expected_id = 0;
+        size_t expected_end = 0;
+        size_t expected_len = 0;
+
+        for ( size_t i = 0; i < literals.size(); i++ ) {
+            const auto& l = literals[i].str();
+            auto pos = data.find(l, start);
+            if ( pos == std::string::npos )
+                continue;
+
+            auto end = pos + l.size();
+            if ( ! expected_id || end < expected_end || (end == expected_end && l.size() > expected_len) ) {
+                expected_id = static_cast<int32_t>(i + 1);
+                expected_end = end;
+                expected_len = l.size();
+            }
+        }
+
+        auto [id, match] = s.find(Bytes(data.substr(start)));
+        CHECK_EQ(id, expected_id);
+        CHECK_EQ(match.size(), expected_len);
+    }
+}
+
+TEST_CASE("find in stream") {
+    const auto s = LiteralSet(Vector<Bytes>({"--boundary"_b, "\r\n.\r\n"_b}));
+
+    auto data = Stream("xxxxx--bou"_b);
+    data.append("nd"_b);
+    data.append("aryyyy"_b);
+
+    auto [id, match] = s.find(data.view());
+    CHECK_EQ(id, 1);
+    CHECK_EQ(match, "--boundary"_b);
+    CHECK_EQ(match.begin().offset(), 5);
+
+    auto [id2, rest] = s.find(data.view().sub(data.at(6), data.end()));
+    CHECK_EQ(id2, 0);
+    CHECK(rest.isEmpty());
+    CHECK_EQ(rest.begin().offset(), 18);
+}
+
+TEST_CASE("Scanner") {
+    const auto s = LiteralSet(Vector<Bytes>({"GET"_b, "POST"_b}));
+    auto scanner = s.scanner();
+
+    auto data = Stream("xxPO"_b);
+    auto view = data.view();
+
+    auto [rc, rest] = scanner.advance(view);
+    CHECK_EQ(rc, -1);
+    CHECK(rest.isEmpty());
+
+    data.append("STyyGE"_b);
+    std::tie(rc, rest) = scanner.advance(rest);
+    CHECK_EQ(rc, 2);
+    CHECK_EQ(scanner.matchLength(), 4);
+    CHECK_EQ(rest, "yyGE"_b);
+
+    std::tie(rc, rest) = scanner.advance(rest);
+    CHECK_EQ(rc, -1);
+
+    data.append("Tzz"_b);
+    std::tie(rc, rest) = scanner.advance(rest);
+    CHECK_EQ(rc, 1);
+    CHECK_EQ(scanner.matchLength(), 3);
+    CHECK_EQ(rest, "zz"_b);
+
+    data.freeze();
+    std::tie(rc, rest) = scanner.advance(rest);
+    CHECK_EQ(rc, 0);
+    CHECK(rest.isEmpty());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,90 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include <doctest/doctest.h>
+
+#include <sstream>
+
+#include <hilti/rt/fiber.h>
+#include <hilti/rt/init.h>
+#include <hilti/rt/profiler.h>
+
+using namespace hilti::rt;
+
+TEST_SUITE_BEGIN("Profiler");
+
+TEST_CASE("start-stop") {
+    init();
+    profiler::reset();
+
+    CHECK_FALSE(profiler::get("test/a"));
+
+    auto p1 = profiler::start("test/a", 10);
+    auto p2 = profiler::start("test/b");
+    profiler::stop(p2);
+    profiler::stop(p1, 15);
+
+    auto p3 = profiler::start("test/a", 20);
+    profiler::stop(p3, 22);
+
+    auto a = profiler::get("test/a");
+    REQUIRE(a);
+    CHECK_EQ(a->count, 2);
+    CHECK_EQ(a->volume, 7);
+    CHECK_EQ(a->yields, 0);
+
+    auto b = profiler::get("test/b");
+    REQUIRE(b);
+    CHECK_EQ(b->count, 1);
+    CHECK_EQ(b->volume, 0);
+
+    CHECK_EQ(profiler::all().size(), 2);
+
+    // Stopping a default-constructed handle is a no-op.
+    profiler::stop(Profiler());
+    CHECK_EQ(profiler::all().size(), 2);
+
+    profiler::reset();
+    CHECK_FALSE(profiler::get("test/a"));
+    CHECK(profiler::all().empty());
+}
+
+TEST_CASE("yields") {
+    init();
+    profiler::reset();
+
+    auto f = [](resumable::Handle* r) {
+        auto p = profiler::start("test/fiber");
+        detail::yield();
+        detail::yield();
+        profiler::stop(p);
+    };
+
+    auto r = fiber::execute(f);
+    REQUIRE_FALSE(r);
+    r.resume();
+    REQUIRE_FALSE(r);
+    r.resume();
+    REQUIRE(r);
+
+    auto m = profiler::get("test/fiber");
+    REQUIRE(m);
+    CHECK_EQ(m->count, 1);
+    CHECK_EQ(m->yields, 2);
+}
+
+TEST_CASE("report") {
+    init();
+    profiler::reset();
+
+    std::stringstream empty;
+    profiler::report(empty);
+    CHECK(empty.str().empty());
+
+    profiler::stop(profiler::start("test/report"));
+
+    std::stringstream x;
+    profiler::report(x);
+    CHECK_NE(x.str().find("test/report"), std::string::npos);
+}
+
+TEST_SUITE_END();
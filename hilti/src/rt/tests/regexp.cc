@@ -4,6 +4,7 @@
 
 #include <doctest/doctest.h>
 
+#include <hilti/rt/configuration.h>
 #include <hilti/rt/types/bytes.h>
 #include <hilti/rt/types/integer.h>
 #include <hilti/rt/types/regexp.h>
@@ -61,6 +62,42 @@ TEST_CASE("findSpan") {
     CHECK_EQ(RegExp(std::vector<std::string>({"abc", "abc"})).findSpan(" abc "_b), std::make_tuple(1, "abc"_b));
 }
 
+TEST_CASE("findSpan without sub-expressions") {
+    const auto flags = regexp::Flags({.no_sub = 1});
+
+    // Leftmost match wins, and extends as far as possible.
+    CHECK_EQ(RegExp("ab*c", flags).findSpan("xxabxabbbcxabbc"_b), std::make_tuple(1, "abbbc"_b));
+    CHECK_EQ(RegExp("a+b", flags).findSpan("caaab ab"_b), std::make_tuple(1, "aaab"_b));
+    CHECK_EQ(RegExp("x(ab|c)+y", flags).findSpan("xaby xcaby"_b), std::make_tuple(1, "xaby"_b));
+    CHECK_EQ(RegExp("ab|b", flags).findSpan("cab"_b), std::make_tuple(1, "ab"_b));
+    CHECK_EQ(RegExp("\\.a+", flags).findSpan("a.b.aa"_b), std::make_tuple(1, ".aa"_b));
+
+    CHECK_EQ(RegExp(std::vector<std::string>({"abd", "abc"}), flags).findSpan("ab abc abd"_b),
+             std::make_tuple(2, "abc"_b));
+    CHECK_EQ(RegExp(std::vector<std::string>({"xyz", "abc"}), flags).findSpan("ab abc xyz"_b),
+             std::make_tuple(2, "abc"_b));
+
+    // Large inputs without a match must not take quadratic time.
+    const auto data = Bytes(std::string(1000000, 'a'));
+    CHECK_EQ(RegExp("a+b", flags).find(data), -1);
+    CHECK_EQ(RegExp("needle", flags).find(data), -1);
+    CHECK_EQ(RegExp("a+b", flags).findSpan(data + "b"_b), std::make_tuple(1, data + "b"_b));
+}
+
+TEST_CASE("findSpan with late leftmost match") {
+    // The match doesn't start at the first candidate offset, so we need to look further.
+    CHECK_EQ(RegExp("abcd|c").findSpan("xabcdc"_b), std::make_tuple(1, "abcd"_b));
+    CHECK_EQ(RegExp("x(ab|c)+y").findSpan("xxcaby"_b), std::make_tuple(1, "xcaby"_b));
+    CHECK_EQ(RegExp("a[^]c]{2,3}b").findSpan("aa]abaxxbab"_b), std::make_tuple(1, "axxb"_b));
+    CHECK_EQ(RegExp("\\x61[[:digit:]]+\\.").findSpan("a1a22."_b), std::make_tuple(1, "a22."_b));
+    CHECK_EQ(RegExp(std::vector<std::string>({"b+c", "ab*d"})).findSpan("abbbcd"_b), std::make_tuple(1, "bbbc"_b));
+
+    // Each candidate offset runs on until the 'c', which must not make this quadratic.
+    const auto data = Bytes(std::string(100000, 'a')) + "cab"_b;
+    CHECK_EQ(RegExp("a[^c]*b").findSpan(data), std::make_tuple(1, "ab"_b));
+    CHECK_EQ(RegExp("a[^c]*b", regexp::Flags({.no_sub = 1})).findSpan(data), std::make_tuple(1, "ab"_b));
+}
+
 TEST_CASE("findGroups") {
     CHECK_EQ(RegExp("abc").findGroups(" abc "_b), Vector<Bytes>({"abc"_b}));
     CHECK_EQ(RegExp("123").findGroups(" abc "_b), Vector<Bytes>());
@@ -69,6 +106,22 @@ TEST_CASE("findGroups") {
                          "cannot capture groups during set matching", const regexp::NotSupported&);
 
     CHECK_EQ(RegExp("(a)bc").findGroups(" abc "_b), Vector<Bytes>({"abc"_b, "a"_b}));
+
+    // Groups are captured just for the leftmost match, wherever it is.
+    CHECK_EQ(RegExp("([a-z]+)=([0-9]+)").findGroups("xx: abc=123 def=456"_b),
+             Vector<Bytes>({"abc=123"_b, "abc"_b, "123"_b}));
+    CHECK_EQ(RegExp("(a|ab)(c|bcd)").findGroups("xxabcdd"_b), Vector<Bytes>({"abcd"_b, "a"_b, "bcd"_b}));
+    CHECK_EQ(RegExp("((a)b)c").findGroups("aababc"_b), Vector<Bytes>({"abc"_b, "ab"_b, "a"_b}));
+    CHECK_EQ(RegExp("^(a)b").findGroups("xab"_b), Vector<Bytes>());
+    CHECK_EQ(RegExp("(a)b$").findGroups("abab"_b), Vector<Bytes>({"ab"_b, "a"_b}));
+
+    // A shorter match starting inside the leftmost one must not provide the groups.
+    CHECK_EQ(RegExp("(c)a*b|(a)").findGroups("xcaab"_b), Vector<Bytes>({"caab"_b, "c"_b}));
+    CHECK_EQ(RegExp("(ca*b|a)").findGroups("caab"_b), Vector<Bytes>({"caab"_b, "caab"_b}));
+    CHECK_EQ(RegExp("(a*)(a)").findGroups("caaa"_b), Vector<Bytes>({"aaa"_b, "aa"_b, "a"_b}));
+
+    const auto data = Bytes(std::string(100000, 'x')) + "abc=123"_b;
+    CHECK_EQ(RegExp("([a-z]+)=([0-9]+)").findGroups(data), Vector<Bytes>({data, data.sub(0, 100003), "123"_b}));
 }
 
 TEST_CASE("construct") {
@@ -76,6 +129,28 @@ TEST_CASE("construct") {
                          const regexp::PatternError&);
 }
 
+TEST_CASE("matchPrefix") {
+    const auto re = RegExp("abc", regexp::Flags({.no_sub = 1}));
+    CHECK_EQ(re.matchPrefix("abc", 3), 1);
+    CHECK_EQ(re.matchPrefix("abcdef", 6), 1);
+    CHECK_EQ(re.matchPrefix("ab", 2), -1);
+    CHECK_EQ(re.matchPrefix("", 0), -1);
+    CHECK_EQ(re.matchPrefix("xabc", 4), 0);
+    CHECK_EQ(re.matchPrefix("abx", 3), 0);
+
+    // Longer matches remain possible, but that doesn't matter.
+    CHECK_EQ(RegExp("ab+", regexp::Flags({.no_sub = 1})).matchPrefix("abbb", 4), 1);
+
+    const auto set = RegExp(std::vector<std::string>({"SSH-", "HTTP/1\\.[01]"}));
+    CHECK_EQ(set.matchPrefix("SSH-2.0", 7), 1);
+    CHECK_EQ(set.matchPrefix("HTTP/1.1 200", 12), 2);
+    CHECK_EQ(set.matchPrefix("HTTP/2", 6), 0);
+    CHECK_EQ(set.matchPrefix("\x16\x03\x01", 3), 0);
+
+    CHECK_THROWS_WITH_AS(RegExp("abc").matchPrefix("abc", 3),
+                         "cannot match prefix of regexp with sub-expressions support", const regexp::NotSupported&);
+}
+
 TEST_CASE("binary data") {
     CHECK_GT(RegExp("\xf0\xfe\xff").find("\xf0\xfe\xff"_b), 0);    // Pass in raw data directly.
     CHECK_GT(RegExp("\\xF0\\xFe\\xff").find("\xf0\xfe\xff"_b), 0); // Let the ctor unescape
@@ -196,4 +271,56 @@ TEST_CASE("reassign") {
     }
 }
 
+TEST_CASE("repeated token matching") {
+    const auto re = RegExp(std::vector<std::string>({"[a-z]+X", "[0-9]+"}), regexp::Flags({.no_sub = 1}));
+    const auto stream = Stream("abcdefX 123"_b);
+    const auto view = stream.view();
+
+    // Fresh matchers reuse the DFA states computed by the first one.
+    for ( auto i = 0; i < 10; i++ ) {
+        auto ms = re.tokenMatcher();
+        CHECK_EQ(std::get<0>(ms.advance(view)), 1);
+    }
+}
+
+TEST_CASE("statistics") {
+    const auto before = RegExp::statistics();
+
+    auto re = RegExp("statistics[0-9]+");
+    CHECK_GT(re.find("abc statistics42"_b), 0);
+    CHECK_LE(re.find("abc"_b), 0);
+
+    const auto after = RegExp::statistics();
+    CHECK_EQ(after.matches, before.matches + 2);
+    CHECK_GT(after.dfa_states, before.dfa_states);
+}
+
+TEST_CASE("DFA state limit") {
+    // Requires a state for each combination of the last 14 input characters.
+    const auto re = RegExp("[ab]*a[ab]{13}c", regexp::Flags({.no_sub = 1}));
+
+    std::string data;
+    uint32_t x = 42;
+    for ( int i = 0; i < 100000; i++ ) {
+        x = x * 1103515245 + 12345;
+        data.push_back((x >> 16U) % 2 ? 'a' : 'b');
+    }
+
+    const auto before = RegExp::statistics();
+
+    auto ms = re.tokenMatcher();
+    CHECK_EQ(std::get<0>(ms.advance(Bytes(std::move(data)), false)), -1);
+
+    const auto middle = RegExp::statistics();
+    CHECK_GT(middle.dfa_flushes, before.dfa_flushes);
+    CHECK_LE(middle.dfa_states_cached, before.dfa_states_cached + configuration::get().regexp_max_dfa_states + 1);
+
+    // The NFA state sets backing the DFA states are bounded as well, not just the states themselves.
+    CHECK_LE(middle.dfa_state_sets_cached,
+             before.dfa_state_sets_cached + configuration::get().regexp_max_dfa_states + 2);
+
+    // Matching continues correctly across flushes.
+    CHECK_EQ(std::get<0>(ms.advance("abbbbbbbbbbbbbc"_b, true)), 1);
+}
+
 TEST_SUITE_END();
@@ -663,6 +663,32 @@ TEST_CASE("Trim with existing iterator and append") {
     CHECK_EQ(*i, '3');
 }
 
+TEST_CASE("Statistics") {
+    const auto before = stream::detail::Chain::statistics();
+
+    {
+        auto x = Stream("0123456789"_b);
+        x.append("abcdefghij"_b);
+
+        auto stats = stream::detail::Chain::statistics();
+        CHECK_EQ(stats.chunks, before.chunks + 2);
+        CHECK_EQ(stats.bytes, before.bytes + 20);
+        CHECK_GE(stats.max_chunks, stats.chunks);
+        CHECK_GE(stats.max_bytes, stats.bytes);
+
+        x.trim(x.at(15));
+
+        stats = stream::detail::Chain::statistics();
+        CHECK_EQ(stats.chunks, before.chunks + 1);
+        CHECK_EQ(stats.bytes, before.bytes + 5);
+        CHECK_EQ(stats.bytes_trimmed, before.bytes_trimmed + 15);
+    }
+
+    const auto after = stream::detail::Chain::statistics();
+    CHECK_EQ(after.chunks, before.chunks);
+    CHECK_EQ(after.bytes, before.bytes);
+}
+
 TEST_CASE("Block iteration") {
     auto content = [](auto b, auto s) -> bool { return memcmp(b->start, s, strlen(s)) == 0; };
 
@@ -886,6 +912,39 @@ TEST_CASE("View") {
 
         CHECK_EQ(trimmed.size(), limit - trim);
     }
+
+    SUBCASE("across chunks") {
+        auto stream = make_stream({"12"_b, "345"_b, ""_b, "6789"_b});
+        REQUIRE_GT(stream.numberChunks(), 2);
+
+        auto view = stream.view();
+        CHECK_EQ(view.size(), 9);
+        CHECK_EQ(view, "123456789"_b);
+        CHECK_EQ(view.data(), "123456789");
+        CHECK_EQ(view.sub(1, 8).size(), 7);
+        CHECK_EQ(view.sub(1, 8), "2345678"_b);
+
+        CHECK_EQ(view.find('5').offset(), 4);
+        CHECK_EQ(view.find('9').offset(), 8);
+        CHECK_EQ(view.find('x'), view.end());
+        CHECK_EQ(view.sub(0, 5).find('7'), view.sub(0, 5).end());
+
+        CHECK(view.startsWith("12345"_b));
+        CHECK(view.advance(1).startsWith("2345678"_b));
+        CHECK_FALSE(view.startsWith("12346"_b));
+        CHECK_FALSE(view.sub(0, 3).startsWith("1234"_b));
+
+        Byte dst[4] = {'0'};
+        CHECK_EQ(view.extract(dst), "56789"_b);
+        CHECK_EQ(vec(dst), std::vector<Byte>({'1', '2', '3', '4'}));
+
+        // A view beyond the currently available data grows with the stream.
+        auto beyond = stream::View(view.begin() + 7, view.begin() + 12);
+        CHECK_EQ(beyond.size(), 2);
+        stream.append("abcd"_b);
+        CHECK_EQ(beyond.size(), 5);
+        CHECK_EQ(beyond, "89abc"_b);
+    }
 }
 
 TEST_SUITE_END();
@@ -1,5 +1,7 @@
 // Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
 
+#include <string>
+
 #include <doctest/doctest.h>
 
 #include <hilti/rt/types/string.h>
@@ -8,17 +10,53 @@ using namespace hilti::rt;
 
 TEST_SUITE_BEGIN("string");
 
+TEST_CASE("asciiPrefix") {
+    const std::string s = "0123456789abcdef0123456789abcdef";
+
+    for ( size_t i = 0; i < s.size(); i++ ) {
+        auto x = s;
+        x[i] = '\x80';
+        CHECK_EQ(string::detail::asciiPrefix(x.data(), x.size()), i);
+        CHECK_EQ(string::detail::asciiPrefix(x.data(), i), i);
+    }
+
+    CHECK_EQ(string::detail::asciiPrefix(s.data(), s.size()), s.size());
+    CHECK_EQ(string::detail::asciiPrefix(s.data(), 0), 0);
+}
+
 TEST_CASE("lower") {
     CHECK_EQ(string::lower(""), "");
     CHECK_EQ(string::lower("123Abc"), "123abc");
     CHECK_EQ(string::lower("GÄNSEFÜẞCHEN"), "gänsefüßchen");
     CHECK_THROWS_WITH_AS(string::lower("\xc3\x28"), "illegal UTF8 sequence in string", const RuntimeError&);
+
+    // Long runs of ASCII with non-ASCII characters at varying offsets.
+    CHECK_EQ(string::lower("Content-Type: TEXT/HTML; Ä=ÖÜ Charset=UTF-8"),
+             "content-type: text/html; ä=öü charset=utf-8");
+    CHECK_THROWS_WITH_AS(string::lower("ABCDEFGHIJKLMNOP\xc3\x28"), "illegal UTF8 sequence in string",
+                         const RuntimeError&);
+}
+
+TEST_CASE("printablePrefix") {
+    const std::string s = "0123456789abcdef0123456789abcdef";
+
+    for ( size_t i = 0; i < s.size(); i++ ) {
+        for ( auto c : {'\x00', '\x1f', '\x7f', '\x80', '\xff'} ) {
+            auto x = s;
+            x[i] = c;
+            CHECK_EQ(string::detail::printablePrefix(x.data(), x.size()), i);
+        }
+    }
+
+    const std::string t = " ~ ~ ~ ~ ~ ~ ~ ~ ~ ~";
+    CHECK_EQ(string::detail::printablePrefix(t.data(), t.size()), t.size());
 }
 
 TEST_CASE("size") {
     CHECK_EQ(string::size(""), 0u);
     CHECK_EQ(string::size("123Abc"), 6u);
     CHECK_EQ(string::size("Gänsefüßchen"), 12);
+    CHECK_EQ(string::size("0123456789abcdefÄ0123456789abcdef"), 33);
     CHECK_THROWS_WITH_AS(string::size("\xc3\x28"), "illegal UTF8 sequence in string", const RuntimeError&);
 }
 
@@ -26,6 +64,8 @@ TEST_CASE("upper") {
     CHECK_EQ(string::upper(""), "");
     CHECK_EQ(string::upper("123Abc"), "123ABC");
     CHECK_EQ(string::upper("Gänsefüßchen"), "GÄNSEFÜẞCHEN");
+    CHECK_EQ(string::upper("content-type: text/html; ä=öü charset=utf-8 [@`{]"),
+             "CONTENT-TYPE: TEXT/HTML; Ä=ÖÜ CHARSET=UTF-8 [@`{]");
     CHECK_THROWS_WITH_AS(string::upper("\xc3\x28"), "illegal UTF8 sequence in string", const RuntimeError&);
 }
 
@@ -12,11 +12,13 @@
 #include <hilti/rt/autogen/version.h>
 #include <hilti/rt/types/integer.h>
 #include <hilti/rt/types/set.h>
+#include <hilti/rt/types/stream.h>
 #include <hilti/rt/types/time.h>
 #include <hilti/rt/types/vector.h>
 #include <hilti/rt/util.h>
 
 using namespace hilti::rt;
+using namespace hilti::rt::bytes::literals;
 
 namespace std {
 ostream& operator<<(ostream& stream, const vector<string_view>& xs) {
@@ -378,6 +380,19 @@ TEST_CASE("memory_statistics") {
     }
 }
 
+TEST_CASE("runtime_statistics") {
+    const auto before = runtime_statistics();
+    CHECK_GT(before.memory_heap, 0);
+
+    const auto s = Stream("0123456789"_b);
+
+    const auto after = runtime_statistics();
+    CHECK_EQ(after.stream_chunks, before.stream_chunks + 1);
+    CHECK_EQ(after.stream_bytes, before.stream_bytes + 10);
+    CHECK_LE(after.stream_bytes, after.max_stream_bytes);
+    CHECK_EQ(after.fiber_stack_bytes > 0, after.num_fibers > 0);
+}
+
 TEST_CASE("pow") {
     using hilti::rt::pow;
     CHECK_EQ(pow(1, 0), 1);
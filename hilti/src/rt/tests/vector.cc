@@ -2,11 +2,16 @@
 
 #include <doctest/doctest.h>
 
+#include <hilti/rt/iterator.h>
+#include <hilti/rt/types/bytes.h>
 #include <hilti/rt/types/integer.h>
+#include <hilti/rt/types/map.h>
+#include <hilti/rt/types/set.h>
 #include <hilti/rt/types/vector.h>
 #include <memory>
 
 using namespace hilti::rt;
+using namespace hilti::rt::bytes::literals;
 
 TEST_SUITE_BEGIN("Vector");
 
@@ -175,6 +180,27 @@ TEST_CASE("Iterator") {
     }
 }
 
+TEST_CASE("Iterator lifetime") {
+    // Iterators bind to the instance they were obtained from, no matter
+    // if that instance had handed out iterators before.
+    auto xs = std::make_unique<Vector<int>>(Vector<int>({1, 2, 3}));
+    auto ys = Vector<int>(*xs);
+    auto zs = Vector<int>(std::move(*xs));
+
+    auto it = xs->begin();
+    CHECK_EQ(ys.begin(), ys.begin());
+    CHECK_NE(ys.begin(), ys.end());
+    CHECK_EQ(*zs.cbegin(), 1);
+    CHECK_THROWS_WITH_AS(operator==(ys.begin(), zs.begin()), "cannot compare iterators into different vectors",
+                         const InvalidArgument&);
+
+    *xs = ys;
+    CHECK_EQ(*it, 1);
+
+    xs.reset();
+    CHECK_THROWS_WITH_AS(*it, "bound object has expired", const InvalidIterator&);
+}
+
 TEST_CASE("ConstIterator") {
     Vector<int> xs;
     auto it = xs.cbegin();
@@ -248,4 +274,37 @@ TEST_CASE("ConstIterator") {
     }
 }
 
+TEST_CASE("unsafe_range") {
+    Vector<int> xs({1, 2, 3});
+    std::vector<int> ys;
+    for ( auto x : unsafe_range(xs) )
+        ys.push_back(x);
+    CHECK_EQ(ys, std::vector<int>({1, 2, 3}));
+
+    // Raw iteration doesn't need the control block.
+    const Vector<int> empty;
+    CHECK_EQ(empty.unsafeBegin(), empty.unsafeEnd());
+
+    const auto b = "ab\xff"_b;
+    std::vector<uint8_t> bs;
+    for ( auto c : unsafe_range(b) )
+        bs.push_back(c);
+    std::vector<uint8_t> safe;
+    for ( auto c : b )
+        safe.push_back(c);
+    CHECK_EQ(bs, safe);
+
+    Set<int> s({3, 1, 2});
+    ys.clear();
+    for ( auto x : unsafe_range(s) )
+        ys.push_back(x);
+    CHECK_EQ(ys, std::vector<int>({1, 2, 3}));
+
+    Map<int, int> m({{1, 10}, {2, 20}});
+    ys.clear();
+    for ( const auto& [k, v] : unsafe_range(m) )
+        ys.push_back(k + v);
+    CHECK_EQ(ys, std::vector<int>({11, 22}));
+}
+
 TEST_SUITE_END();
@@ -46,8 +46,11 @@ Bytes::Bytes(std::string s, bytes::Charset cs) {
             return;
 
         case bytes::Charset::ASCII: {
-            // Convert all bytes to 7-bit codepoints.
-            std::for_each(s.begin(), s.end(), [](auto&& c) { c = (c >= 32 && c < 0x7f) ? static_cast<char>(c) : '?'; });
+            // Convert all bytes to 7-bit codepoints, skipping the leading
+            // printable part that stays unchanged.
+            auto n = string::detail::printablePrefix(s.data(), s.size());
+            std::for_each(s.begin() + n, s.end(),
+                          [](auto&& c) { c = (c >= 32 && c < 0x7f) ? static_cast<char>(c) : '?'; });
 
             *this = std::move(s);
             return;
@@ -66,13 +69,24 @@ std::string Bytes::decode(bytes::Charset cs) const {
             return str();
 
         case bytes::Charset::ASCII: {
-            // Convert non-printable to the unicode replacement character.
+            // Convert non-printable to the unicode replacement character,
+            // copying runs of printable characters over in bulk.
+            const auto& data = str();
+            auto p = data.data();
+            auto e = p + data.size();
+
             std::string s;
-            for ( auto c : *this ) {
-                if ( c >= 32 && c < 0x7f )
-                    s += static_cast<char>(c);
-                else
+            s.reserve(data.size());
+
+            while ( p < e ) {
+                auto n = string::detail::printablePrefix(p, e - p);
+                s.append(p, n);
+                p += n;
+
+                if ( p < e ) {
                     s += "\ufffd";
+                    ++p;
+                }
             }
 
             return s;
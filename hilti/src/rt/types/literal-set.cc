@@ -0,0 +1,209 @@
+// Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
+
+#include "hilti/rt/types/literal-set.h"
+
+#include <array>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace hilti::rt;
+using namespace hilti::rt::literal_set;
+using hilti::rt::stream::Byte;
+
+struct literal_set::detail::Automaton {
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    uint64_t size = 0;                   // Number of literals.
+    std::array<uint16_t, 256> classes{}; // Maps input bytes to their equivalence class.
+    uint32_t num_classes = 1;            // Class 0 is all bytes not appearing in any literal.
+    std::vector<uint32_t> delta;         // Transition table, indexed by state * num_classes + class.
+    std::vector<int32_t> accepts;        // ID of the literal to report for each state, or zero.
+    std::vector<uint32_t> lengths;       // Length of the literal to report for each state.
+    int first_byte = -1;                 // The first byte of all literals if they share it, or -1.
+
+    uint32_t next(uint32_t state, Byte b) const { return delta[state * num_classes + classes[b]]; }
+
+    // Runs the automaton across a block of raw data, beginning in `*state`
+    // and stopping right after the first match. Returns the number of bytes
+    // consumed.
+    uint64_t scan(uint32_t* state, const Byte* data, uint64_t size) const {
+        auto s = *state;
+        auto p = data;
+        const auto end = data + size;
+
+        while ( p < end ) {
+            if ( s == 0 && first_byte >= 0 ) {
+                // Nothing in progress, skip ahead to where a literal might start.
+                p = reinterpret_cast<const Byte*>(memchr(p, first_byte, end - p));
+                if ( ! p ) {
+                    p = end;
+                    break;
+                }
+            }
+
+            s = next(s, *p++);
+
+            if ( accepts[s] )
+                break;
+        }
+
+        *state = s;
+        return p - data;
+    }
+};
+
+LiteralSet::LiteralSet(const Vector<Bytes>& literals) {
+    auto a = std::make_shared<literal_set::detail::Automaton>();
+    a->size = literals.size();
+
+    bool first_literal = true;
+
+    for ( const auto& l : literals ) {
+        if ( l.isEmpty() )
+            throw InvalidArgument("literal set cannot contain empty literals");
+
+        for ( auto c : l.str() ) {
+            auto& cls = a->classes[static_cast<Byte>(c)];
+            if ( ! cls )
+                cls = a->num_classes++;
+        }
+
+        auto first = static_cast<Byte>(l.str()[0]);
+
+        if ( first_literal )
+            a->first_byte = first;
+        else if ( a->first_byte != first )
+            a->first_byte = -1;
+
+        first_literal = false;
+    }
+
+    const auto nc = a->num_classes;
+
+    auto new_state = [&]() {
+        a->delta.resize(a->delta.size() + nc, literal_set::detail::Automaton::None);
+        a->accepts.push_back(0);
+        a->lengths.push_back(0);
+        return static_cast<uint32_t>(a->accepts.size() - 1);
+    };
+
+    // Build the trie.
+    new_state();
+
+    int32_t id = 0;
+    for ( const auto& l : literals ) {
+        ++id;
+        uint32_t s = 0;
+
+        for ( auto c : l.str() ) {
+            auto& t = a->delta[s * nc + a->classes[static_cast<Byte>(c)]];
+
+            if ( t == literal_set::detail::Automaton::None ) {
+                auto n = new_state(); // May invalidate `t`.
+                a->delta[s * nc + a->classes[static_cast<Byte>(c)]] = n;
+                s = n;
+            }
+            else
+                s = t;
+        }
+
+        if ( ! a->accepts[s] ) {
+            // For duplicates, the first one wins.
+            a->accepts[s] = id;
+            a->lengths[s] = l.size();
+        }
+    }
+
+    // Turn the trie into a full transition table by following failure links
+    // in breadth-first order. A state inherits the longest literal ending at
+    // its failure state if it doesn't complete one itself.
+    std::vector<uint32_t> fail(a->accepts.size(), 0);
+    std::deque<uint32_t> queue;
+
+    for ( uint32_t c = 0; c < nc; c++ ) {
+        auto& t = a->delta[c];
+
+        if ( t == literal_set::detail::Automaton::None )
+            t = 0;
+        else
+            queue.push_back(t);
+    }
+
+    while ( ! queue.empty() ) {
+        auto s = queue.front();
+        queue.pop_front();
+
+        for ( uint32_t c = 0; c < nc; c++ ) {
+            auto& t = a->delta[s * nc + c];
+            auto f = a->delta[fail[s] * nc + c];
+
+            if ( t == literal_set::detail::Automaton::None ) {
+                t = f;
+                continue;
+            }
+
+            fail[t] = f;
+
+            if ( ! a->accepts[t] ) {
+                a->accepts[t] = a->accepts[f];
+                a->lengths[t] = a->lengths[f];
+            }
+
+            queue.push_back(t);
+        }
+    }
+
+    _automaton = std::move(a);
+}
+
+uint64_t LiteralSet::size() const { return _automaton ? _automaton->size : 0; }
+
+std::tuple<int32_t, Bytes> LiteralSet::find(const Bytes& data) const {
+    if ( ! _automaton )
+        return std::make_tuple(0, Bytes());
+
+    uint32_t state = 0;
+    auto n = _automaton->scan(&state, reinterpret_cast<const Byte*>(data.str().data()), data.size());
+
+    if ( auto id = _automaton->accepts[state] )
+        return std::make_tuple(id, data.sub(n - _automaton->lengths[state], n));
+
+    return std::make_tuple(0, Bytes());
+}
+
+std::tuple<int32_t, stream::View> LiteralSet::find(const stream::View& data) const {
+    auto s = Scanner(*this);
+    auto [rc, rest] = s.advance(data);
+
+    if ( rc > 0 ) {
+        auto end = rest.begin().offset() - data.begin().offset();
+        return std::make_tuple(rc, data.sub(data.begin() + (end - s.matchLength()), rest.begin()));
+    }
+
+    return std::make_tuple(0, rest);
+}
+
+Scanner::Scanner(const LiteralSet& literals) : _automaton(literals._automaton) {}
+
+std::tuple<int32_t, stream::View> Scanner::advance(const stream::View& data) {
+    if ( ! _automaton )
+        return std::make_tuple(data.isFrozen() ? 0 : -1, data.trim(data.end()));
+
+    uint64_t consumed = 0;
+
+    for ( auto block = data.firstBlock(); block; block = data.nextBlock(block) ) {
+        auto n = _automaton->scan(&_state, block->start, block->size);
+        consumed += n;
+
+        // If nothing got consumed, we may still be sitting on the previous match.
+        if ( auto id = _automaton->accepts[_state]; id && n ) {
+            _match_length = _automaton->lengths[_state];
+            return std::make_tuple(id, data.trim(data.begin() + consumed));
+        }
+    }
+
+    return std::make_tuple(data.isFrozen() ? 0 : -1, data.trim(data.end()));
+}
@@ -5,9 +5,17 @@
 
 #include "hilti/rt/types/regexp.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include <hilti/rt/configuration.h>
 #include <hilti/rt/util.h>
 
 extern "C" {
@@ -27,61 +35,126 @@ public:
     jrx_match_state _ms{};
     std::shared_ptr<jrx_regex_t> _jrx;
 
-    ~Pimpl() { jrx_match_state_done(&_ms); }
+    ~Pimpl() {
+        if ( _ms.dfa )
+            jrx_match_state_done(&_ms);
+    }
 
     Pimpl(std::shared_ptr<jrx_regex_t> jrx) : _jrx(std::move(jrx)) { jrx_match_state_init(_jrx.get(), 0, &_ms); }
 
     Pimpl(const Pimpl& other) : _acc(other._acc), _first(other._first), _jrx(other._jrx) {
         jrx_match_state_copy(&other._ms, &_ms);
     }
+
+    Pimpl(Pimpl&& other) noexcept : _acc(other._acc), _first(other._first), _jrx(std::move(other._jrx)) {
+        jrx_match_state_move(&other._ms, &_ms);
+        other._ms.dfa = nullptr; // We own any of its memory now.
+    }
+
+    // Releases the matcher once matching has completed. The match state
+    // must let go of the DFA before we do, as the DFA keeps track of it.
+    void finish() {
+        if ( _ms.dfa ) {
+            jrx_match_state_done(&_ms);
+            _ms.dfa = nullptr;
+        }
+
+        _jrx = nullptr;
+    }
 };
 
+regexp::MatchState::Pimpl* regexp::MatchState::_pimpl() const {
+    static_assert(sizeof(Pimpl) <= sizeof(_storage), "storage for MatchState::Pimpl too small");
+    static_assert(alignof(Pimpl) <= alignof(decltype(_storage)), "storage for MatchState::Pimpl misaligned");
+
+    if ( ! _initialized )
+        return nullptr;
+
+    return reinterpret_cast<Pimpl*>(const_cast<decltype(_storage)*>(&_storage));
+}
+
+void regexp::MatchState::_reset() {
+    if ( ! _initialized )
+        return;
+
+    _pimpl()->~Pimpl();
+    _initialized = false;
+}
+
 regexp::MatchState::MatchState(const RegExp& re) {
     if ( re.patterns().empty() )
         throw regexp::PatternError("trying to match empty pattern set");
 
-    _pimpl = std::make_unique<Pimpl>(re._jrxShared());
+    new (&_storage) Pimpl(re._jrxShared());
+    _initialized = true;
 }
 
 regexp::MatchState::MatchState(const MatchState& other) {
-    if ( this == &other )
+    if ( this == &other || ! other._initialized )
         return;
 
-    if ( other._pimpl->_jrx->cflags & REG_STD_MATCHER )
+    if ( other._pimpl()->_ms.cflags & REG_STD_MATCHER )
         throw InvalidArgument("cannot copy match state of regexp with sub-expressions support");
 
-    _pimpl = std::make_unique<Pimpl>(*other._pimpl);
+    new (&_storage) Pimpl(*other._pimpl());
+    _initialized = true;
 }
 
 regexp::MatchState& regexp::MatchState::operator=(const MatchState& other) {
     if ( this == &other )
         return *this;
 
-    if ( other._pimpl->_jrx->cflags & REG_STD_MATCHER )
+    if ( other._initialized && other._pimpl()->_ms.cflags & REG_STD_MATCHER )
         throw InvalidArgument("cannot copy match state of regexp with sub-expressions support");
 
-    _pimpl = std::make_unique<Pimpl>(*other._pimpl);
+    _reset();
+
+    if ( other._initialized ) {
+        new (&_storage) Pimpl(*other._pimpl());
+        _initialized = true;
+    }
 
     return *this;
 }
 
-regexp::MatchState::MatchState() noexcept = default;
-regexp::MatchState& regexp::MatchState::operator=(MatchState&&) noexcept = default;
-regexp::MatchState::MatchState(MatchState&&) noexcept = default;
+regexp::MatchState::MatchState(MatchState&& other) noexcept {
+    if ( ! other._initialized )
+        return;
+
+    new (&_storage) Pimpl(std::move(*other._pimpl()));
+    _initialized = true;
+    other._reset();
+}
 
-regexp::MatchState::~MatchState() = default;
+regexp::MatchState& regexp::MatchState::operator=(MatchState&& other) noexcept {
+    if ( this == &other )
+        return *this;
+
+    _reset();
+
+    if ( other._initialized ) {
+        new (&_storage) Pimpl(std::move(*other._pimpl()));
+        _initialized = true;
+        other._reset();
+    }
+
+    return *this;
+}
+
+regexp::MatchState::MatchState() noexcept = default;
+regexp::MatchState::~MatchState() { _reset(); }
 
 std::tuple<int32_t, stream::View> regexp::MatchState::advance(const stream::View& data) {
-    if ( ! _pimpl )
+    if ( ! _initialized )
         throw PatternError("no regular expression associated with match state");
 
-    if ( ! _pimpl->_jrx )
+    if ( ! _pimpl()->_jrx )
         throw MatchStateReuse("matching already complete");
 
     auto [rc, offset] = _advance(data, data.isFrozen());
 
     if ( rc >= 0 ) {
-        _pimpl->_jrx = nullptr;
+        _pimpl()->finish();
         return std::make_tuple(rc, data.trim(data.begin() + offset));
     }
 
@@ -89,16 +162,16 @@ std::tuple<int32_t, stream::View> regexp::MatchState::advance(const stream::View
 }
 
 std::tuple<int32_t, uint64_t> regexp::MatchState::advance(const Bytes& data, bool is_final) {
-    if ( ! _pimpl )
+    if ( ! _initialized )
         throw PatternError("no regular expression associated with match state");
 
-    if ( ! _pimpl->_jrx )
+    if ( ! _pimpl()->_jrx )
         throw MatchStateReuse("matching already complete");
 
     auto [rc, offset] = _advance(Stream(data).view(), is_final);
 
     if ( rc >= 0 ) {
-        _pimpl->_jrx = nullptr;
+        _pimpl()->finish();
         return std::make_tuple(rc, offset);
     }
 
@@ -106,19 +179,21 @@ std::tuple<int32_t, uint64_t> regexp::MatchState::advance(const Bytes& data, boo
 }
 
 std::pair<int32_t, uint64_t> regexp::MatchState::_advance(const stream::View& data, bool is_final) {
-    jrx_assertion first = _pimpl->_first;
+    ++RegExp::_total_matches;
+
+    jrx_assertion first = _pimpl()->_first;
     jrx_assertion last = 0;
 
     if ( data.size() )
-        _pimpl->_first = 0;
+        _pimpl()->_first = 0;
 
-    _pimpl->_ms.offset = 1; // See below why 1.
+    _pimpl()->_ms.offset = 1; // See below why 1.
 
     if ( data.isEmpty() ) {
-        if ( is_final && _pimpl->_acc <= 0 )
-            _pimpl->_acc = jrx_current_accept(&_pimpl->_ms);
+        if ( is_final && _pimpl()->_acc <= 0 )
+            _pimpl()->_acc = jrx_current_accept(&_pimpl()->_ms);
 
-        return std::make_pair(is_final ? _pimpl->_acc : -1, 0);
+        return std::make_pair(is_final ? _pimpl()->_acc : -1, 0);
     }
 
     stream::detail::UnsafeConstIterator cur(data.begin());
@@ -150,44 +225,51 @@ std::pair<int32_t, uint64_t> regexp::MatchState::_advance(const stream::View& da
                          escapeBytes(std::string_view((const char*)block_start, block_len)), data.safeBegin().offset());
 #endif
 
-        rc = jrx_regexec_partial(_pimpl->_jrx.get(), reinterpret_cast<const char*>(block_start), block_len, first, last,
-                                 &_pimpl->_ms, is_final);
+        rc = jrx_regexec_partial(_pimpl()->_jrx.get(), reinterpret_cast<const char*>(block_start), block_len, first,
+                                 last, &_pimpl()->_ms, is_final);
 
         // FIXME: The jrx match_state intializes the offset with 1. Not sure
         // why right now but changing that would probably break other things
         // we adjust that here for the calculation.
-        uint64_t view_offset = chunk->offset() + _pimpl->_ms.offset - 1 - cur.chunk()->offset();
+        uint64_t view_offset = chunk->offset() + _pimpl()->_ms.offset - 1 - cur.chunk()->offset();
 
 #ifdef _DEBUG_MATCHING
-        std::cerr << fmt("-> state=%p rc=%d ms->offset=%d\n", this, rc, _pimpl->_ms.offset);
+        std::cerr << fmt("-> state=%p rc=%d ms->offset=%d\n", this, rc, _pimpl()->_ms.offset);
 #endif
 
         if ( rc == 0 )
             // No further match possible.
-            return std::make_pair(_pimpl->_acc > 0 ? _pimpl->_acc : 0, view_offset);
+            return std::make_pair(_pimpl()->_acc > 0 ? _pimpl()->_acc : 0, view_offset);
 
         if ( rc > 0 ) {
             // Match found. However, we need to wait for more data that could
             // potentially be included into the match before returning it.
-            if ( ! is_final && jrx_can_transition(&_pimpl->_ms) )
+            if ( ! is_final && jrx_can_transition(&_pimpl()->_ms) )
                 return std::make_pair(-1, 0);
 
-            _pimpl->_acc = rc;
-            return std::make_pair(_pimpl->_acc, view_offset);
+            _pimpl()->_acc = rc;
+            return std::make_pair(_pimpl()->_acc, view_offset);
         }
     };
 
-    if ( rc < 0 && _pimpl->_acc == 0 )
+    if ( rc < 0 && _pimpl()->_acc == 0 )
         // At least one could match with more data.
-        _pimpl->_acc = -1;
+        _pimpl()->_acc = -1;
 
-    return std::make_pair(_pimpl->_acc, 0);
+    return std::make_pair(_pimpl()->_acc, 0);
+}
+
+// Completes compilation, and limits the DFA's size per the runtime's configuration.
+static void _finalizeJrx(jrx_regex_t* jrx) {
+    jrx_regset_finalize(jrx);
+    jrx_regset_set_max_states(jrx, configuration::get().regexp_max_dfa_states);
 }
 
 RegExp::RegExp(std::string pattern, regexp::Flags flags) : _flags(flags) {
     _newJrx();
     _compileOne(std::move(pattern), 0);
-    jrx_regset_finalize(_jrx());
+    _finalizeJrx(_jrx());
+    _prepareSearch();
 }
 
 
@@ -202,7 +284,8 @@ RegExp::RegExp(const std::vector<std::string>& patterns, regexp::Flags flags) :
     for ( const auto& p : patterns )
         _compileOne(p, idx++);
 
-    jrx_regset_finalize(_jrx());
+    _finalizeJrx(_jrx());
+    _prepareSearch();
 }
 
 void RegExp::_newJrx() {
@@ -231,6 +314,328 @@ void RegExp::_compileOne(std::string pattern, int idx) {
     _patterns.push_back(std::move(pattern));
 }
 
+// Returns a literal that all matches of a pattern must start with, or an
+// empty string if we can't tell. This is conservative: we stop at the first
+// construct that isn't a plain character, and give up if the pattern has
+// alternatives outside of any group.
+static std::string _literalPrefix(std::string_view pattern) {
+    int depth = 0;
+
+    for ( size_t i = 0; i < pattern.size(); i++ ) {
+        switch ( pattern[i] ) {
+            case '\\': i++; break;
+            case '(': depth++; break;
+            case ')': depth--; break;
+            case '|':
+                if ( depth <= 0 )
+                    return "";
+
+                break;
+
+            case '[':
+                // Skip the character class, which may start with a literal ']'.
+                if ( ++i < pattern.size() && pattern[i] == '^' )
+                    i++;
+
+                if ( i < pattern.size() && pattern[i] == ']' )
+                    i++;
+
+                while ( i < pattern.size() && pattern[i] != ']' ) {
+                    if ( pattern.substr(i, 2) == "[:" ) {
+                        if ( i = pattern.find(":]", i); i == std::string_view::npos )
+                            return "";
+
+                        i++;
+                    }
+                    else if ( pattern[i] == '\\' )
+                        i++;
+
+                    i++;
+                }
+
+                break;
+        }
+    }
+
+    const auto special = std::string_view("|*+?.(){}[]^$");
+    const auto quantifiers = std::string_view("*+?{");
+    std::string prefix;
+
+    for ( size_t i = 0; i < pattern.size(); i++ ) {
+        auto c = pattern[i];
+
+        if ( c == '\\' ) {
+            // Only escaped punctuation stands for itself.
+            if ( i + 1 >= pattern.size() || isalnum(static_cast<unsigned char>(pattern[i + 1])) )
+                break;
+
+            c = pattern[++i];
+        }
+        else if ( special.find(c) != std::string_view::npos )
+            break;
+
+        if ( i + 1 < pattern.size() && quantifiers.find(pattern[i + 1]) != std::string_view::npos )
+            break;
+
+        prefix += c;
+    }
+
+    return prefix;
+}
+
+// Returns the end of the character class starting at `i`, or `npos` if we
+// can't find it. The first character inside may be a literal ']'.
+static size_t _cclEnd(std::string_view pattern, size_t i) {
+    auto j = i + 1;
+
+    if ( j < pattern.size() && pattern[j] == '^' )
+        j++;
+
+    for ( auto first = true; j < pattern.size(); first = false ) {
+        if ( pattern.substr(j, 2) == "[:" ) {
+            if ( j = pattern.find(":]", j); j == std::string_view::npos )
+                return std::string_view::npos;
+
+            j += 2;
+        }
+        else if ( pattern[j] == '\\' )
+            j += 2;
+        else if ( pattern[j] == ']' && ! first )
+            return j + 1;
+        else
+            j++;
+    }
+
+    return std::string_view::npos;
+}
+
+static std::optional<std::string> _reverseAlternatives(std::string_view pattern, size_t* i);
+
+// Reverses a sequence of atoms and their quantifiers, stopping at the end
+// of the current alternative.
+static std::optional<std::string> _reverseSequence(std::string_view pattern, size_t* i) {
+    std::vector<std::string> items;
+
+    while ( *i < pattern.size() && pattern[*i] != '|' && pattern[*i] != ')' ) {
+        std::string atom;
+
+        switch ( pattern[*i] ) {
+            case '(': {
+                ++*i;
+                auto inner = _reverseAlternatives(pattern, i);
+                if ( ! inner || *i >= pattern.size() || pattern[*i] != ')' )
+                    return {};
+
+                ++*i;
+                atom = "(" + *inner + ")";
+                break;
+            }
+
+            case '[': {
+                auto end = _cclEnd(pattern, *i);
+                if ( end == std::string_view::npos )
+                    return {};
+
+                atom = pattern.substr(*i, end - *i);
+                *i = end;
+                break;
+            }
+
+            case '\\': {
+                if ( *i + 1 >= pattern.size() || pattern[*i + 1] == 'b' || pattern[*i + 1] == 'B' )
+                    return {};
+
+                auto end = *i + 2;
+
+                if ( pattern[*i + 1] >= '0' && pattern[*i + 1] <= '7' ) {
+                    while ( end < pattern.size() && pattern[end] >= '0' && pattern[end] <= '7' )
+                        end++;
+                }
+                else if ( pattern[*i + 1] == 'x' && *i + 3 < pattern.size() &&
+                          isxdigit(static_cast<unsigned char>(pattern[*i + 2])) &&
+                          isxdigit(static_cast<unsigned char>(pattern[*i + 3])) )
+                    end += 2;
+
+                atom = pattern.substr(*i, end - *i);
+                *i = end;
+                break;
+            }
+
+            case '{':
+                if ( pattern.substr(*i, 2) == "{#" ) {
+                    // The accept ID, which must come last. We don't need it.
+                    if ( pattern.find('}', *i) != pattern.size() - 1 )
+                        return {};
+
+                    *i = pattern.size();
+                    continue;
+                }
+
+                if ( *i + 1 >= pattern.size() || ! isdigit(static_cast<unsigned char>(pattern[*i + 1])) )
+                    return {};
+
+                break; // a quantifier applying to an empty atom
+
+            case '*':
+            case '+':
+            case '?': break; // a quantifier applying to an empty atom
+
+            case '^':
+            case '$':
+                // Assertions don't carry over to the reverse direction directly.
+                return {};
+
+            default: atom = pattern[(*i)++];
+        }
+
+        while ( *i < pattern.size() ) {
+            auto c = pattern[*i];
+
+            if ( c == '*' || c == '+' || c == '?' )
+                atom += pattern[(*i)++];
+
+            else if ( c == '{' && *i + 1 < pattern.size() && isdigit(static_cast<unsigned char>(pattern[*i + 1])) ) {
+                auto end = pattern.find('}', *i);
+                if ( end == std::string_view::npos )
+                    return {};
+
+                atom += pattern.substr(*i, end - *i + 1);
+                *i = end + 1;
+            }
+
+            else
+                break;
+        }
+
+        items.push_back(std::move(atom));
+    }
+
+    std::string result;
+
+    for ( auto j = items.rbegin(); j != items.rend(); j++ )
+        result += *j;
+
+    return result;
+}
+
+static std::optional<std::string> _reverseAlternatives(std::string_view pattern, size_t* i) {
+    std::string result;
+
+    while ( true ) {
+        auto seq = _reverseSequence(pattern, i);
+        if ( ! seq )
+            return {};
+
+        result += *seq;
+
+        if ( *i >= pattern.size() || pattern[*i] != '|' )
+            return result;
+
+        result += '|';
+        ++*i;
+    }
+}
+
+// Returns a pattern matching the reverse of everything that a given pattern
+// matches, or nothing if we can't build one. We give up on assertions, and
+// on any syntax we don't recognize. Any accept ID gets dropped.
+static std::optional<std::string> _reversePattern(std::string_view pattern) {
+    size_t i = 0;
+    auto result = _reverseAlternatives(pattern, &i);
+
+    if ( i != pattern.size() )
+        return {}; // unbalanced parentheses
+
+    return result;
+}
+
+void RegExp::_prepareSearch() {
+    // With word boundaries, a match may depend on data before its start,
+    // which the anchored matching at individual offsets doesn't see. We
+    // stay with trying all offsets for those to keep results consistent.
+    for ( const auto& p : _patterns ) {
+        if ( p.find("\\b") != std::string::npos || p.find("\\B") != std::string::npos )
+            return;
+
+        // The minimal matcher that we search with doesn't evaluate
+        // end-of-line assertions like the capturing one does, so we leave
+        // regexps using those to the latter.
+        if ( ! _flags.no_sub && p.find('$') != std::string::npos )
+            return;
+    }
+
+    _linear_search = true;
+
+    _prefix = _literalPrefix(_patterns.front());
+
+    for ( const auto& p : _patterns ) {
+        auto q = _literalPrefix(p);
+        _prefix.resize(std::mismatch(_prefix.begin(), _prefix.end(), q.begin(), q.end()).first - _prefix.begin());
+    }
+
+    for ( const auto& p : _patterns ) {
+        auto r = _reversePattern(p);
+        if ( ! r ) {
+            _reversed_patterns.clear();
+            break;
+        }
+
+        _reversed_patterns.push_back(std::move(*r));
+    }
+}
+
+std::shared_ptr<jrx_regex_t> RegExp::_compileVariant(const std::vector<std::string>& patterns, int cflags) const {
+    auto jrx = std::shared_ptr<jrx_regex_t>(new jrx_regex_t, [=](auto j) {
+        jrx_regfree(j);
+        delete j;
+    });
+
+    jrx_regset_init(jrx.get(), -1, cflags);
+
+    for ( const auto& p : patterns ) {
+        // Can't fail, we have compiled the (original) pattern before already.
+        [[maybe_unused]] auto rc = jrx_regset_add(jrx.get(), p.c_str(), p.size());
+        assert(rc == REG_OK);
+    }
+
+    _finalizeJrx(jrx.get());
+    return jrx;
+}
+
+jrx_regex_t* RegExp::_jrxSearch() const {
+    if ( ! _jrx_search )
+        _jrx_search = _compileVariant(_patterns, REG_EXTENDED | REG_LAZY | REG_NOSUB | REG_FIRST_MATCH);
+
+    return _jrx_search.get();
+}
+
+jrx_regex_t* RegExp::_jrxAnchored() const {
+    if ( _flags.no_sub )
+        return _jrx();
+
+    if ( ! _jrx_anchored )
+        _jrx_anchored = _compileVariant(_patterns, REG_EXTENDED | REG_LAZY | REG_NOSUB | REG_ANCHOR);
+
+    return _jrx_anchored.get();
+}
+
+jrx_regex_t* RegExp::_jrxAnchoredGroups() const {
+    if ( ! _jrx_anchored_groups )
+        _jrx_anchored_groups = _compileVariant(_patterns, REG_EXTENDED | REG_LAZY | REG_ANCHOR);
+
+    return _jrx_anchored_groups.get();
+}
+
+jrx_regex_t* RegExp::_jrxReverse() const {
+    if ( _reversed_patterns.empty() )
+        return nullptr;
+
+    if ( ! _jrx_reverse )
+        _jrx_reverse = _compileVariant(_reversed_patterns, REG_EXTENDED | REG_LAZY | REG_NOSUB);
+
+    return _jrx_reverse.get();
+}
+
 int32_t RegExp::find(const Bytes& data) const {
     assert(_jrx() && "regexp not compiled");
 
@@ -270,27 +675,64 @@ Vector<Bytes> RegExp::findGroups(const Bytes& data) const {
     jrx_offset eo = -1;
     jrx_match_state ms;
     auto rc = _search_pattern(&ms, data, &so, &eo, false, true);
+    jrx_match_state_done(&ms);
 
     Vector<Bytes> groups;
 
     if ( rc > 0 ) {
         groups.emplace_back(_subslice(data, so, eo));
 
-        if ( auto num_groups = jrx_num_groups(_jrx()); num_groups > 1 ) {
+        if ( auto num_groups = jrx_num_groups(_jrx()); num_groups > 1 && ! _flags.no_sub ) {
+            // Now that we know where the match is, we run the (slower)
+            // capturing matcher across just that part of the data to get the
+            // groups. We anchor it at the start of the match, so that it
+            // can't pick up the groups of a different match that starts
+            // later inside the same data.
+            jrx_assertion first = (so == 0 ? JRX_ASSERTION_BOL | JRX_ASSERTION_BOD : 0);
+            jrx_assertion last =
+                (eo == static_cast<jrx_offset>(data.size()) ? JRX_ASSERTION_EOL | JRX_ASSERTION_EOD : 0);
+
+            auto jrx = _jrxAnchoredGroups();
+            jrx_match_state_init(jrx, so, &ms);
+            jrx_regexec_partial(jrx, reinterpret_cast<const char*>(data.data()) + so, eo - so, first, last, &ms, true);
+
             jrx_regmatch_t pmatch[num_groups];
-            jrx_reggroups(_jrx(), &ms, num_groups, pmatch);
+            jrx_reggroups(jrx, &ms, num_groups, pmatch);
 
             for ( int i = 1; i < num_groups; i++ ) {
                 if ( pmatch[i].rm_so >= 0 )
                     groups.emplace_back(_subslice(data, pmatch[i].rm_so, pmatch[i].rm_eo));
             }
+
+            jrx_match_state_done(&ms);
         }
     }
 
-    jrx_match_state_done(&ms);
     return groups;
 }
 
+int32_t RegExp::matchPrefix(const char* data, size_t size) const {
+    assert(_jrx() && "regexp not compiled");
+
+    if ( ! _flags.no_sub )
+        throw regexp::NotSupported("cannot match prefix of regexp with sub-expressions support");
+
+    ++_total_matches;
+
+    jrx_match_state ms;
+    jrx_match_state_init(_jrx(), 0, &ms);
+
+    jrx_accept_id rc = jrx_regexec_partial(_jrx(), data, size, JRX_ASSERTION_BOL | JRX_ASSERTION_BOD, 0, &ms, 0);
+
+    // We don't care about finding the longest match, so any accept we have
+    // come across settles it.
+    if ( ms.acc > 0 )
+        rc = ms.acc;
+
+    jrx_match_state_done(&ms);
+    return rc;
+}
+
 regexp::MatchState RegExp::tokenMatcher() const { return regexp::MatchState(*this); }
 
 // TODO: This is stripped down version of the previous view-based matchig
@@ -303,6 +745,8 @@ jrx_accept_id RegExp::_search_pattern(jrx_match_state* ms, const Bytes& data, jr
     const jrx_assertion last = JRX_ASSERTION_EOL | JRX_ASSERTION_EOD;
     jrx_assertion first = JRX_ASSERTION_BOL | JRX_ASSERTION_BOD;
 
+    ++_total_matches;
+
     jrx_accept_id acc = 0;
     int8_t need_msdone = 0;
 
@@ -312,6 +756,94 @@ jrx_accept_id RegExp::_search_pattern(jrx_match_state* ms, const Bytes& data, jr
         return -1;
     }
 
+    if ( _linear_search && ! do_anchor && find_partial_matches && ! jrx_is_anchored(_jrxAnchored()) ) {
+        // Rather than trying to match at every offset, we first skip ahead to
+        // where the literal prefix of the pattern occurs (if there's one),
+        // and then make a single pass over the remaining data with an
+        // unanchored version of the regexp. That tells us in linear time if
+        // there's a match at all, and if so, where the earliest one ends.
+        // Only then we go find where the match starts, which can't be after
+        // that end. That way we report the same leftmost, longest match as
+        // trying all offsets would.
+        //
+        // We do this with the minimal matcher even if the regexp supports
+        // capture groups, as we don't need them for finding the match.
+        // The returned match state then belongs to the minimal matcher as
+        // well; findGroups() takes care of getting the groups separately.
+        auto input = std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+        auto next = [&](size_t from) { return _prefix.empty() ? from : input.find(_prefix, from); };
+
+        auto start = next(0);
+        if ( start == std::string_view::npos ) {
+            jrx_match_state_init(_jrxAnchored(), 0, ms);
+            return -1;
+        }
+
+        jrx_match_state sms;
+        jrx_match_state_init(_jrxSearch(), start, &sms);
+        auto rc = jrx_regexec_partial(_jrxSearch(), input.data() + start, input.size() - start,
+                                      (start == 0 ? first : 0), last, &sms, find_partial_matches);
+        auto end = start + sms.offset - 1; // see below for the -1
+        jrx_match_state_done(&sms);
+
+        // Returns the longest match starting at a given offset, if any.
+        auto match_at = [&](size_t cur) {
+            jrx_match_state_init(_jrxAnchored(), cur, ms);
+            auto match = jrx_regexec_partial(_jrxAnchored(), input.data() + cur, input.size() - cur,
+                                             (cur == 0 ? first : 0), last, ms, find_partial_matches);
+
+            if ( match > 0 ) {
+                if ( so )
+                    *so = cur;
+
+                if ( eo )
+                    *eo = cur + ms->offset - 1;
+            }
+            else
+                jrx_match_state_done(ms);
+
+            return match;
+        };
+
+        if ( rc > 0 ) {
+            // Usually, the match starts right at the first candidate.
+            if ( rc = match_at(start); rc > 0 )
+                return rc;
+
+            if ( auto reverse = _jrxReverse() ) {
+                // Otherwise, we make one pass backwards over the remaining
+                // data with a reversed version of the regexp. The longest
+                // match it finds from the end ends where the leftmost match
+                // starts. That keeps the search linear even if many
+                // candidate offsets turn out to lead nowhere only late.
+                auto reversed = std::string(input.rbegin(), input.rend() - static_cast<ptrdiff_t>(start + 1));
+
+                jrx_match_state rms;
+                jrx_match_state_init(reverse, 0, &rms);
+                auto rrc = jrx_regexec_partial(reverse, reversed.data(), reversed.size(), 0, 0, &rms, true);
+                auto len = rms.offset - 1; // see below for the -1
+                jrx_match_state_done(&rms);
+
+                if ( rrc > 0 ) {
+                    if ( rc = match_at(input.size() - len); rc > 0 )
+                        return rc;
+                }
+            }
+
+            else {
+                // Without a reversed regexp, we try all candidates in turn.
+                for ( auto cur = next(start + 1); cur != std::string_view::npos && cur <= end; cur = next(cur + 1) ) {
+                    if ( rc = match_at(cur); rc > 0 )
+                        return rc;
+                }
+            }
+        }
+
+        // No match.
+        jrx_match_state_init(_jrxAnchored(), 0, ms);
+        return -1;
+    }
+
     jrx_offset cur = 0;
 
     while ( acc <= 0 && cur < data.size() ) {
@@ -557,3 +1089,12 @@ std::string hilti::rt::detail::adl::to_string(const RegExp& x, adl::tag /*unused
 
     return fmt("%s %s", p, join(f, " "));
 }
+
+RegExp::Statistics RegExp::statistics() {
+    Statistics stats{.dfa_states = jrx_dfa_states_computed(),
+                     .dfa_states_cached = jrx_dfa_states_cached(),
+                     .dfa_state_sets_cached = jrx_dfa_state_sets_cached(),
+                     .dfa_flushes = jrx_dfa_flushes(),
+                     .matches = _total_matches};
+    return stats;
+}
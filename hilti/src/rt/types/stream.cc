@@ -2,6 +2,8 @@
 
 #include "rt/types/stream.h"
 
+#include <algorithm>
+
 #include <hilti/rt/extension-points.h>
 #include <hilti/rt/types/bytes.h>
 
@@ -9,6 +11,38 @@ using namespace hilti::rt;
 using namespace hilti::rt::stream;
 using namespace hilti::rt::stream::detail;
 
+// Helper iterating over the raw data between a starting position and an end
+// offset, calling a function for each continuous block of memory in
+// between. The function receives a pointer to the block's first byte, the
+// number of bytes available there, and the block's stream offset; it
+// returns false to abort iteration. This avoids going through the checked
+// iterators for each individual byte.
+template<typename F>
+static void forEachBlock(const UnsafeConstIterator& begin, uint64_t end, F f) {
+    auto offset = begin.offset().Ref();
+
+    for ( auto c = begin.chunk(); c && offset < end; c = c->next().get() ) {
+        auto c_begin = c->offset().Ref();
+        auto c_end = c_begin + c->size().Ref();
+
+        if ( offset >= c_end )
+            continue;
+
+        auto n = std::min(c_end, end) - offset;
+
+        if ( ! f(c->begin() + (offset - c_begin), n, offset) )
+            return;
+
+        offset += n;
+    }
+}
+
+// Helper iterating over all raw data inside a view, see above.
+template<typename F>
+static void forEachBlock(const View& v, F f) {
+    forEachBlock(v.unsafeBegin(), v.unsafeEnd().offset().Ref(), std::move(f));
+}
+
 Chunk::Chunk(const View& d) : _offset(0) {
     if ( d.size() <= SmallBufferSize ) {
         std::array<Byte, SmallBufferSize> a{};
@@ -70,10 +104,21 @@ void Chunk::trim(Offset o) {
 }
 
 SafeConstIterator View::find(Byte b, const SafeConstIterator& n) const {
-    for ( auto i = UnsafeConstIterator(n ? n : _begin); i != UnsafeConstIterator(end()); ++i ) {
-        if ( *i == b )
-            return SafeConstIterator(i);
-    }
+    const auto& start = (n ? n : _begin);
+    const auto end_ = unsafeEnd().offset().Ref();
+    std::optional<uint64_t> found;
+
+    forEachBlock(UnsafeConstIterator(start), end_, [&](const Byte* p, uint64_t size, uint64_t offset) {
+        if ( auto x = reinterpret_cast<const Byte*>(memchr(p, b, size)) ) {
+            found = offset + (x - p);
+            return false;
+        }
+
+        return true;
+    });
+
+    if ( found )
+        return start + (*found - start.offset());
 
     return end();
 }
@@ -137,22 +182,30 @@ std::tuple<bool, SafeConstIterator> View::find(const Bytes& v, const SafeConstIt
 }
 
 bool View::startsWith(const Bytes& b) const {
-    auto s1 = unsafeBegin();
-    auto e1 = unsafeEnd();
-    auto s2 = b.begin();
-    auto e2 = b.end();
+    auto s2 = reinterpret_cast<const Byte*>(b.str().data());
+    auto e2 = s2 + b.size();
+
+    forEachBlock(*this, [&](const Byte* p, uint64_t size, uint64_t /* offset */) {
+        auto n = std::min(size, static_cast<uint64_t>(e2 - s2));
 
-    while ( s1 != e1 && s2 != e2 ) {
-        if ( *s1++ != *s2++ )
+        if ( memcmp(p, s2, n) != 0 ) {
+            s2 = nullptr;
             return false;
-    }
+        }
+
+        s2 += n;
+        return s2 != e2;
+    });
 
     return s2 == e2;
 }
 
 void View::copyRaw(Byte* dst) const {
-    for ( auto i = unsafeBegin(); i != unsafeEnd(); ++i )
-        *dst++ = *i;
+    forEachBlock(*this, [&](const Byte* p, uint64_t size, uint64_t /* offset */) {
+        memcpy(dst, p, size);
+        dst += size;
+        return true;
+    });
 }
 
 std::optional<View::Block> View::firstBlock() const {
@@ -211,6 +264,31 @@ std::optional<View::Block> View::nextBlock(std::optional<Block> current) const {
     }
 }
 
+Chain::Chain(std::shared_ptr<Chunk>&& head, std::shared_ptr<Chunk>&& tail)
+    : head(std::move(head)), tail(std::move(tail)) {
+    uint64_t chunks = 0;
+    uint64_t bytes = 0;
+
+    for ( auto c = this->head.get(); c; c = c->next().get() ) {
+        ++chunks;
+        bytes += c->size();
+    }
+
+    added(chunks, bytes);
+}
+
+Chain::~Chain() {
+    uint64_t chunks = 0;
+    uint64_t bytes = 0;
+
+    for ( auto c = head.get(); c; c = c->next().get() ) {
+        ++chunks;
+        bytes += c->size();
+    }
+
+    removed(chunks, bytes, false);
+}
+
 Stream::Stream(const Bytes& d) : Stream(Chunk(d.str())) {}
 
 int Stream::numberChunks() const {
@@ -273,6 +351,7 @@ void Stream::trim(const stream::SafeConstIterator& i) {
     for ( auto c = ch->head; c; c = c->next() ) {
         if ( i.offset() >= c->offset() + c->size() ) {
             // Delete chunk.
+            Chain::removed(1, c->size(), true);
             ch->head = c->next();
             if ( c->isLast() )
                 ch->tail = c->next();
@@ -283,6 +362,7 @@ void Stream::trim(const stream::SafeConstIterator& i) {
                 // become invalid.
                 auto chain = _content;
                 chain->head = chain->tail = std::shared_ptr<Chunk>(new Chunk(i.offset(), {}, 0));
+                Chain::added(1, 0);
                 return;
             }
 
@@ -290,6 +370,7 @@ void Stream::trim(const stream::SafeConstIterator& i) {
         }
 
         if ( c->offset() <= i.offset() && i.offset() < c->offset() + c->size() ) {
+            Chain::removed(0, (i.offset() - c->offset()).Ref(), true);
             c->trim(i.offset());
             break;
         }
@@ -327,28 +408,29 @@ Stream::Content Stream::deepCopyContent() const {
 }
 
 Size View::size() const {
-    if ( end().offset() <= _begin.offset() )
+    auto end_ = end().offset();
+
+    if ( end_ <= _begin.offset() )
         return 0;
 
-    // Not so great: Because our end offset may point beyond what's currently
-    // available, we actually need to iterate through and count.
-    //
-    // TODO(robin): We can build a better loop though.
-    Size s = 0;
-    auto x = end();
-    auto end_ = detail::UnsafeConstIterator(end());
-    for ( auto i = detail::UnsafeConstIterator(_begin); i != end_; ++i )
-        s++;
+    // Our end offset may point beyond what's currently available, so we
+    // need to cap it at the end of the actual data.
+    auto content = _begin.content();
+    if ( ! (content && content->tail && _begin.chunk()) )
+        return 0;
 
-    return s;
+    if ( auto data_end = content->tail->offset() + content->tail->size(); end_ > data_end )
+        end_ = data_end;
+
+    return end_ > _begin.offset() ? end_ - _begin.offset() : Size(0);
 }
 
 std::string Stream::data() const {
     std::string s;
     s.reserve(size());
 
-    for ( auto i = unsafeBegin(); i != unsafeEnd(); ++i )
-        s += static_cast<char>(*i);
+    for ( auto c = head(); c; c = c->next().get() )
+        s.append(reinterpret_cast<const char*>(c->begin()), c->size());
 
     return s;
 }
@@ -357,8 +439,10 @@ std::string stream::View::data() const {
     std::string s;
     s.reserve(size());
 
-    for ( auto i = unsafeBegin(); i != unsafeEnd(); ++i )
-        s += static_cast<char>(*i);
+    forEachBlock(*this, [&](const Byte* p, uint64_t size, uint64_t /* offset */) {
+        s.append(reinterpret_cast<const char*>(p), size);
+        return true;
+    });
 
     return s;
 }
@@ -384,15 +468,7 @@ bool stream::View::operator==(const Bytes& other) const {
     if ( size() != other.size() )
         return false;
 
-    auto i = unsafeBegin();
-    auto j = other.begin();
-
-    while ( i != unsafeEnd() ) {
-        if ( *i++ != *j++ )
-            return false;
-    }
-
-    return true;
+    return startsWith(other);
 }
 
 std::string hilti::rt::detail::adl::to_string(const stream::SafeConstIterator& x, adl::tag /*unused*/) {
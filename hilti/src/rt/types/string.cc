@@ -2,71 +2,118 @@
 
 #include "hilti/rt/types/string.h"
 
+#include <cstring>
+
 #include <hilti/3rdparty/utf8proc/utf8proc.h>
 #include <hilti/rt/exception.h>
 
 using namespace hilti::rt;
 
-size_t string::size(const std::string& s) {
-    auto p = reinterpret_cast<const unsigned char*>(s.data());
-    auto e = p + s.size();
+// Helpers operating on 8 bytes at a time, see
+// https://graphics.stanford.edu/~seander/bithacks.html#HasLessInWord.
+static constexpr uint64_t _ones = 0x0101010101010101ULL;
+static constexpr uint64_t _highs = 0x8080808080808080ULL;
 
-    size_t len = 0;
+static inline uint64_t _load(const char* p) {
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
 
-    while ( p < e ) {
-        utf8proc_int32_t cp;
-        auto n = utf8proc_iterate(p, e - p, &cp);
+size_t string::detail::asciiPrefix(const char* data, size_t size) {
+    size_t i = 0;
 
-        if ( n < 0 )
-            throw RuntimeError("illegal UTF8 sequence in string");
+    while ( i + 8 <= size && ! (_load(data + i) & _highs) )
+        i += 8;
 
-        ++len;
-        p += n;
+    while ( i < size && ! (static_cast<unsigned char>(data[i]) & 0x80U) )
+        ++i;
+
+    return i;
+}
+
+size_t string::detail::printablePrefix(const char* data, size_t size) {
+    size_t i = 0;
+
+    while ( i + 8 <= size ) {
+        auto x = _load(data + i);
+        auto below = (x - _ones * 0x20U) & ~x;  // High bit set for bytes < 0x20 ...
+        auto above = (x + _ones * 0x01U) | x;   // ... and for bytes > 0x7e.
+        if ( (below | above) & _highs )
+            break;
+
+        i += 8;
     }
 
-    return len;
+    while ( i < size && data[i] >= 32 && data[i] < 0x7f )
+        ++i;
+
+    return i;
 }
 
-std::string string::upper(const std::string& s) {
-    auto p = reinterpret_cast<const unsigned char*>(s.data());
+// Applies a case mapping to a UTF8 string, handling runs of ASCII
+// directly and passing everything else through utf8proc.
+template<typename F>
+static std::string _mapCase(const std::string& s, char from, char to, F map) {
+    auto p = s.data();
     auto e = p + s.size();
 
     unsigned char buf[4];
     std::string rval;
+    rval.reserve(s.size());
 
     while ( p < e ) {
+        auto n = string::detail::asciiPrefix(p, e - p);
+
+        for ( auto q = p; q < p + n; ++q )
+            rval.push_back((*q >= from && *q <= to) ? static_cast<char>(*q ^ 0x20) : *q);
+
+        p += n;
+
+        if ( p == e )
+            break;
+
         utf8proc_int32_t cp;
-        auto n = utf8proc_iterate(p, e - p, &cp);
+        auto m = utf8proc_iterate(reinterpret_cast<const unsigned char*>(p), e - p, &cp);
 
-        if ( n < 0 )
+        if ( m < 0 )
             throw RuntimeError("illegal UTF8 sequence in string");
 
-        auto m = utf8proc_encode_char(utf8proc_toupper(cp), buf);
-        rval += std::string(reinterpret_cast<char*>(buf), m);
-        p += n;
+        auto k = utf8proc_encode_char(map(cp), buf);
+        rval.append(reinterpret_cast<char*>(buf), k);
+        p += m;
     }
 
     return rval;
 }
 
-std::string string::lower(const std::string& s) {
-    auto p = reinterpret_cast<const unsigned char*>(s.data());
+size_t string::size(const std::string& s) {
+    auto p = s.data();
     auto e = p + s.size();
 
-    unsigned char buf[4];
-    std::string rval;
+    size_t len = 0;
 
     while ( p < e ) {
+        auto n = detail::asciiPrefix(p, e - p);
+        len += n;
+        p += n;
+
+        if ( p == e )
+            break;
+
         utf8proc_int32_t cp;
-        auto n = utf8proc_iterate(p, e - p, &cp);
+        auto m = utf8proc_iterate(reinterpret_cast<const unsigned char*>(p), e - p, &cp);
 
-        if ( n < 0 )
+        if ( m < 0 )
             throw RuntimeError("illegal UTF8 sequence in string");
 
-        auto m = utf8proc_encode_char(utf8proc_tolower(cp), buf);
-        rval += std::string(reinterpret_cast<char*>(buf), m);
-        p += n;
+        ++len;
+        p += m;
     }
 
-    return rval;
+    return len;
 }
+
+std::string string::upper(const std::string& s) { return _mapCase(s, 'a', 'z', utf8proc_toupper); }
+
+std::string string::lower(const std::string& s) { return _mapCase(s, 'A', 'Z', utf8proc_tolower); }
@@ -18,6 +18,8 @@
 #include <hilti/rt/exception.h>
 #include <hilti/rt/fiber.h>
 #include <hilti/rt/fmt.h>
+#include <hilti/rt/types/regexp.h>
+#include <hilti/rt/types/stream.h>
 #include <hilti/rt/util.h>
 
 std::string hilti::rt::version() {
@@ -67,6 +69,38 @@ hilti::rt::MemoryStatistics hilti::rt::memory_statistics() {
     return stats;
 }
 
+hilti::rt::RuntimeStatistics hilti::rt::runtime_statistics() {
+    RuntimeStatistics stats;
+
+    struct rusage r;
+    getrusage(RUSAGE_SELF, &r);
+    auto streams = stream::detail::Chain::statistics();
+    auto fibers = detail::Fiber::statistics();
+    auto regexps = RegExp::statistics();
+
+    stats.memory_heap = r.ru_maxrss * 1024;
+    stats.stream_chunks = streams.chunks;
+    stats.max_stream_chunks = streams.max_chunks;
+    stats.stream_bytes = streams.bytes;
+    stats.max_stream_bytes = streams.max_bytes;
+    stats.stream_bytes_trimmed = streams.bytes_trimmed;
+    stats.num_fibers = fibers.current;
+    stats.max_fibers = fibers.max;
+    stats.cached_fibers = fibers.cached;
+    stats.fiber_stack_bytes = fibers.stack_bytes;
+    stats.fiber_switches = fibers.switches;
+    stats.resumables = fibers.functions;
+    stats.resumable_yields = fibers.yields;
+    stats.max_resumable_yields = fibers.max_yields;
+    stats.resumables_direct = fibers.direct;
+    stats.regexp_dfa_states = regexps.dfa_states;
+    stats.regexp_dfa_cached = regexps.dfa_states_cached;
+    stats.regexp_dfa_flushes = regexps.dfa_flushes;
+    stats.regexp_matches = regexps.matches;
+
+    return stats;
+}
+
 hilti::rt::Result<std::filesystem::path> hilti::rt::createTemporaryFile(const std::string& prefix) {
     std::error_code ec;
     auto tmp_dir = std::filesystem::temp_directory_path(ec);
@@ -5,6 +5,7 @@
 #include <iostream>
 
 #include <hilti/hilti.h>
+#include <hilti/json.h>
 #include <spicy/spicy.h>
 
 #include <hilti/rt/libhilti.h>
@@ -24,6 +25,8 @@ static struct option long_driver_options[] = {{"abort-on-exceptions", required_a
                                               {"list-parsers", no_argument, nullptr, 'l'},
                                               {"optimize", no_argument, nullptr, 'O'},
                                               {"parser", required_argument, nullptr, 'p'},
+                                              {"profile", no_argument, nullptr, 'Z'},
+                                              {"report-statistics", no_argument, nullptr, 's'},
                                               {"report-times", required_argument, nullptr, 'R'},
                                               {"show-backtraces", required_argument, nullptr, 'B'},
                                               {"skip-dependencies", no_argument, nullptr, 'S'},
@@ -43,8 +46,10 @@ public:
 
     void parseOptions(int argc, char** argv);
     void usage();
+    void reportStatistics(std::ostream& out);
 
     bool opt_list_parsers = false;
+    bool opt_report_statistics = false;
     int opt_increment = 0;
     std::string opt_file = "/dev/stdin";
     std::string opt_parser;
@@ -68,6 +73,8 @@ void SpicyDriver::usage() {
            "  -l | --list-parsers             List available parsers and exit.\n"
            "  -p | --parser <name>            Use parser <name> to process input. Only neeeded if more than one parser "
            "is available.\n"
+           "  -s | --report-statistics        Print runtime statistics as JSON to stderr once all input has been "
+           "processed.\n"
            "  -v | --version                  Print version information.\n"
            "  -A | --abort-on-exceptions      When executing compiled code, abort() instead of throwing HILTI "
            "exceptions.\n"
@@ -80,6 +87,7 @@ void SpicyDriver::usage() {
            "  -S | --skip-dependencies        Do not automatically compile dependencies during JIT.\n"
            "  -X | --debug-addl <addl>        Implies -d and adds selected additional instrumentation "
            "(comma-separated; see 'help' for list).\n"
+           "  -Z | --profile                  Profile execution of parsers, and report the results at the end.\n"
            "\n"
            "Environment variables:\n"
            "\n"
@@ -103,7 +111,7 @@ void SpicyDriver::parseOptions(int argc, char** argv) {
     driver_options.logger = std::make_unique<hilti::Logger>();
 
     while ( true ) {
-        int c = getopt_long(argc, argv, "ABD:f:hdJX:OVlp:i:SRL:", long_driver_options, nullptr);
+        int c = getopt_long(argc, argv, "ABD:f:hdJX:OVlp:i:sSRL:Z", long_driver_options, nullptr);
 
         if ( c < 0 )
             break;
@@ -181,12 +189,16 @@ void SpicyDriver::parseOptions(int argc, char** argv) {
 
             case 'R': driver_options.report_times = true; break;
 
+            case 's': opt_report_statistics = true; break;
+
             case 'S': driver_options.skip_dependencies = true; break;
 
             case 'v': std::cerr << "spicy-driver v" << hilti::configuration().version_string_long << std::endl; exit(0);
 
             case 'L': compiler_options.library_paths.emplace_back(optarg); break;
 
+            case 'Z': compiler_options.enable_profiling = true; break;
+
             case 'h': usage(); exit(0);
             case '?': usage(); exit(1); // getopt reports error
             default: usage(); fatalError(fmt("option %c not supported", c));
@@ -204,6 +216,44 @@ void SpicyDriver::parseOptions(int argc, char** argv) {
     }
 }
 
+void SpicyDriver::reportStatistics(std::ostream& out) {
+    auto rt = hilti::rt::runtime_statistics();
+    auto sinks = spicy::rt::Sink::statistics();
+
+    nlohmann::json stats = {
+        {"memory", {{"heap", rt.memory_heap}}},
+        {"streams",
+         {{"chunks", rt.stream_chunks},
+          {"max_chunks", rt.max_stream_chunks},
+          {"bytes", rt.stream_bytes},
+          {"max_bytes", rt.max_stream_bytes},
+          {"bytes_trimmed", rt.stream_bytes_trimmed}}},
+        {"fibers",
+         {{"current", rt.num_fibers},
+          {"max", rt.max_fibers},
+          {"cached", rt.cached_fibers},
+          {"stack_bytes", rt.fiber_stack_bytes},
+          {"switches", rt.fiber_switches}}},
+        {"resumables",
+         {{"finished", rt.resumables},
+          {"yields", rt.resumable_yields},
+          {"max_yields", rt.max_resumable_yields},
+          {"direct", rt.resumables_direct}}},
+        {"sinks",
+         {{"buffered", sinks.buffered},
+          {"max_buffered", sinks.max_buffered},
+          {"gaps", sinks.gaps},
+          {"overlaps", sinks.overlaps}}},
+        {"regexps",
+         {{"dfa_states", rt.regexp_dfa_states},
+          {"dfa_cached", rt.regexp_dfa_cached},
+          {"dfa_flushes", rt.regexp_dfa_flushes},
+          {"matches", rt.regexp_matches}}},
+    };
+
+    out << stats.dump() << std::endl;
+}
+
 int main(int argc, char** argv) {
     SpicyDriver driver;
 
@@ -234,6 +284,10 @@ int main(int argc, char** argv) {
                 fatalError("cannot open stdin for reading");
 
             driver.processInput(**parser, in, driver.opt_increment);
+
+            if ( driver.opt_report_statistics )
+                driver.reportStatistics(std::cerr);
+
             driver.finishRuntime();
         }
 
@@ -82,7 +82,14 @@ public:
     Engine engine() const { return _engine; }
 
     bool isContainer() const { return repeatCount().has_value(); }
-    auto isTransient() const { return _is_anonynmous; }
+
+    /**
+     * Returns true if the field's value won't be stored in the unit. That's
+     * the case for anonymous fields, as well as for fields that have been
+     * marked with an internal `&no-emit` attribute because nobody is
+     * accessing them.
+     */
+    auto isTransient() const { return _is_anonynmous || AttributeSet::has(attributes(), "&no-emit"); }
 
     Type parseType() const;
 
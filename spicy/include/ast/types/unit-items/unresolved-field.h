@@ -101,6 +101,19 @@ public:
     // Node interface.
     auto properties() const { return node::Properties{{"engine", to_string(_engine)}}; }
 
+    /**
+     * Copies an existing field but replaces its attributes.
+     *
+     * @param f original field
+     * @param attrs new attributes
+     * @return new field with attributes replaced
+     */
+    static UnresolvedField setAttributes(const UnresolvedField& f, const AttributeSet& attrs) {
+        auto x = UnresolvedField(f);
+        x.childs()[3] = attrs;
+        return x;
+    }
+
 private:
     Engine _engine;
     const int _args_start;
@@ -134,6 +134,13 @@ struct ParserState {
 
     /** Mode for parsing literals. */
     LiteralMode literal_mode = LiteralMode::Default;
+
+    /**
+     * If set, boolean expression that's true if all the input needed by the
+     * current block of fixed-size fields is available already. Fields inside
+     * the block can then skip waiting for their own input.
+     */
+    std::optional<Expression> have_fixed_input;
 };
 
 /** Generates the parsing logic for a unit type. */
@@ -172,6 +179,17 @@ public:
      */
     Expression parseMethodExternalOverload2(const type::Unit& t);
 
+    /**
+     * Returns the literal a host application can search for in its input to
+     * resynchronize a unit's parsing after an error. That's the constant
+     * bytes literal that every instance of the unit starts with, if the
+     * grammar marks it (or a field leading to it) with `&synchronize`.
+     *
+     * @return the literal, or nothing if the unit doesn't have a
+     * synchronization point
+     */
+    std::optional<Expression> synchronizationLiteral(const type::Unit& t);
+
     /**
      * Adds a unit's external parsing methods to the HILTI struct
      * corresponding to the parse object. Returns the modified type.
@@ -374,6 +392,25 @@ public:
      */
     void trimInput(bool force = false);
 
+    /**
+     * Generates code that starts a profiler measurement, recording the
+     * current input position as its volume. Does nothing if profiling isn't
+     * enabled.
+     *
+     * @param name name of the measurement
+     * @return expression referencing the running profiler if profiling is enabled
+     */
+    std::optional<Expression> startProfiler(const std::string& name);
+
+    /**
+     * Generates code that finishes a profiler measurement previously started
+     * through `startProfiler()`, recording the input consumed since then.
+     *
+     * @param profiler value returned by the corresponding `startProfiler()`;
+     * if not set, the method does nothing
+     */
+    void stopProfiler(const std::optional<Expression>& profiler);
+
     /**
      * Generates code that initializes a unit instance just before parsing
      * begins.
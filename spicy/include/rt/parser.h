@@ -29,17 +29,21 @@ namespace spicy::rt {
  */
 struct Parser {
     Parser(std::string name, Parse1Function parse1, std::any parse2, std::string description,
-           hilti::rt::Vector<MIMEType> mime_types, hilti::rt::Vector<hilti::rt::Port> ports)
+           hilti::rt::Vector<MIMEType> mime_types, hilti::rt::Vector<hilti::rt::Port> ports,
+           std::optional<hilti::rt::Bytes> synchronize_at = {})
         : name(std::move(name)),
           parse1(parse1),
           parse2(std::move(parse2)),
           description(std::move(description)),
           mime_types(std::move(mime_types)),
-          ports(std::move(ports)) {}
+          ports(std::move(ports)),
+          synchronize_at(std::move(synchronize_at)) {}
 
     Parser(std::string name, hilti::rt::Null /* null */, std::any parse2, std::string description,
-           hilti::rt::Vector<MIMEType> mime_types, hilti::rt::Vector<hilti::rt::Port> ports)
-        : Parser(std::move(name), nullptr, parse2, std::move(description), std::move(mime_types), std::move(ports)) {}
+           hilti::rt::Vector<MIMEType> mime_types, hilti::rt::Vector<hilti::rt::Port> ports,
+           std::optional<hilti::rt::Bytes> synchronize_at = {})
+        : Parser(std::move(name), nullptr, parse2, std::move(description), std::move(mime_types), std::move(ports),
+                 std::move(synchronize_at)) {}
 
     Parser(const Parser&) = default;
 
@@ -76,6 +80,14 @@ struct Parser {
      */
     hilti::rt::Vector<hilti::rt::Port> ports;
 
+    /**
+     * Literal that every instance of the unit starts with, if the grammar
+     * marks it as a synchronization point through `&synchronize`. After a
+     * parse error, a host application may search its input for the next
+     * occurrence of this literal and restart parsing from there.
+     */
+    std::optional<hilti::rt::Bytes> synchronize_at;
+
     /**
      * For internal use only. Set by `registerParser()` for units that's don't
      * receive arguments.
@@ -243,6 +243,17 @@ public:
      */
     void write(hilti::rt::Bytes data, std::optional<uint64_t> seq = {}, std::optional<uint64_t> len = {});
 
+    /** Statistics about reassembly across all sink instances. */
+    struct Statistics {
+        uint64_t buffered;     // number of bytes currently buffered for reassembly
+        uint64_t max_buffered; // high-water mark for number of bytes buffered for reassembly
+        uint64_t gaps;         // number of gaps reported so far
+        uint64_t overlaps;     // number of overlaps reported so far
+    };
+
+    /** Returns statistics about reassembly across all sink instances. */
+    static Statistics statistics();
+
     /**
      * Tracks connected filters. This is internal, but needs to be public
      * because some free-standing functions are accessing it.
@@ -259,7 +270,28 @@ private:
         uint64_t rupper;                      // Sequence number of last byte + 1.
 
         Chunk(std::optional<hilti::rt::Bytes> data, uint64_t rseq, uint64_t rupper)
-            : data(std::move(data)), rseq(rseq), rupper(rupper) {}
+            : data(std::move(data)), rseq(rseq), rupper(rupper) {
+            if ( this->data ) {
+                _total_buffered += this->data->size();
+
+                if ( _total_buffered > _max_buffered )
+                    _max_buffered = _total_buffered;
+            }
+        }
+
+        // Moving transfers the buffered data, leaving the source without any.
+        Chunk(Chunk&& other) noexcept : data(std::move(other.data)), rseq(other.rseq), rupper(other.rupper) {
+            other.data.reset();
+        }
+
+        ~Chunk() {
+            if ( data )
+                _total_buffered -= data->size();
+        }
+
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+        Chunk& operator=(Chunk&&) = delete;
     };
 
     using ChunkList = std::list<Chunk>;
@@ -342,6 +374,11 @@ private:
     uint64_t _last_reassem_rseq{}; // Sequence of last byte reassembled and delivered + 1.
     uint64_t _trim_rseq{};         // Sequence of last byte trimmed so far + 1.
     ChunkList _chunks;             // Buffered data not yet delivered or trimmed
+
+    inline static uint64_t _total_buffered;
+    inline static uint64_t _max_buffered;
+    inline static uint64_t _total_gaps;
+    inline static uint64_t _total_overlaps;
 };
 
 } // namespace spicy::rt
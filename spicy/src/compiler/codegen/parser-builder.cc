@@ -12,6 +12,7 @@
 #include <hilti/base/cache.h>
 #include <hilti/base/logger.h>
 #include <hilti/compiler/context.h>
+#include <hilti/rt/types/regexp.h>
 #include <spicy/ast/types/bitfield.h>
 #include <spicy/ast/types/unit-items/field.h>
 #include <spicy/ast/types/unit-items/sink.h>
@@ -26,6 +27,9 @@
 #include <hilti/base/visitor.h>
 #include <spicy/compiler/detail/codegen/productions/all.h>
 
+#include <functional>
+#include <map>
+#include <set>
 #include <utility>
 
 using namespace spicy;
@@ -35,6 +39,10 @@ using hilti::util::fmt;
 
 namespace builder = hilti::builder;
 
+// Maximum number of elements to reserve space for when parsing a vector
+// with a known number of elements.
+static const uint64_t MaximumCounterReservation = 1024;
+
 const hilti::Type look_ahead::Type = hilti::type::SignedInteger(64); // TODO(cppcoreguidelines-interfaces-global-init)
 const hilti::Expression look_ahead::None = builder::integer(0);      // TODO(cppcoreguidelines-interfaces-global-init)
 const hilti::Expression look_ahead::Eod = builder::integer(-1);      // TODO(cppcoreguidelines-interfaces-global-init)
@@ -108,8 +116,14 @@ struct ProductionVisitor
     Expression _parseProduction(const Production& p, const production::Meta& meta, bool forwarding) {
         const auto is_field_owner = (meta.field() && meta.isFieldProduction() && ! p.isA<production::Resolved>());
 
-        if ( meta.field() && meta.isFieldProduction() )
+        std::optional<Expression> profiler;
+
+        if ( meta.field() && meta.isFieldProduction() ) {
+            if ( is_field_owner )
+                profiler = pb->startProfiler(fmt("spicy/unit/%s::%s", state().unit_id, meta.field()->id()));
+
             preParseField(p, meta, is_field_owner);
+        }
 
         beginProduction(p);
 
@@ -389,8 +403,10 @@ struct ProductionVisitor
 
         endProduction(p);
 
-        if ( meta.field() && meta.isFieldProduction() )
+        if ( meta.field() && meta.isFieldProduction() ) {
             postParseField(p, meta, is_field_owner);
+            pb->stopProfiler(profiler);
+        }
 
         return stop;
     }
@@ -557,6 +573,96 @@ struct ProductionVisitor
         return _parseProduction(forwarded_to, p.meta(), true);
     }
 
+    // Returns the number of bytes that parsing a production will always
+    // consume, if that's a constant and nothing about the production
+    // changes the way input is accessed. With random access, hooks may move
+    // the current position through `set_input()`, so we don't make any
+    // assumptions there.
+    std::optional<uint64_t> fixedInputSize(const Production& p) {
+        static const std::set<std::string> ok_attributes = {"&byte-order", "&bit-order", "&convert",
+                                                            "&ipv4",       "&ipv6",      "&requires"};
+
+        auto v = p.tryAs<production::Variable>();
+        if ( ! v )
+            return {};
+
+        const auto& meta = p.meta();
+        const auto& field = meta.field();
+
+        if ( ! (field && meta.isFieldProduction()) || meta.container() || field->condition() ||
+             state().literal_mode != LiteralMode::Default || state().unit.get().usesRandomAccess() )
+            return {};
+
+        if ( auto attrs = field->attributes() ) {
+            for ( const auto& a : attrs->attributes() ) {
+                if ( ok_attributes.find(a.tag()) == ok_attributes.end() )
+                    return {};
+            }
+        }
+
+        const auto& t = v->type();
+
+        if ( auto i = t.tryAs<hilti::type::UnsignedInteger>() )
+            return i->width() / 8;
+
+        if ( auto i = t.tryAs<hilti::type::SignedInteger>() )
+            return i->width() / 8;
+
+        if ( auto b = t.tryAs<spicy::type::Bitfield>() )
+            return b->width() / 8;
+
+        if ( t.isA<hilti::type::Address>() )
+            return AttributeSet::find(field->attributes(), "&ipv4") ? 4 : 16;
+
+        return {};
+    }
+
+    // Parses a sequence of productions. Consecutive fields of constant size
+    // are grouped into blocks that check just once if all their input is
+    // available already. If so, the fields skip checking individually;
+    // otherwise, they wait for their input one by one as usual.
+    //
+    // Inside a block, the fields still decode their values through HILTI's
+    // `unpack` operator, which always verifies that the view holds enough
+    // data and reports a `result` error otherwise. We don't emit unchecked
+    // reads instead, because HILTI has no such operation: the Spicy parser
+    // only ever unpacks through the type-generic `unpack`. Adding an
+    // unchecked variant would save just that single size comparison per
+    // field. The expensive part, the call into waitForInput() that may
+    // suspend parsing, is what the block check removes.
+    void parseSequence(const std::vector<Production>& prods) {
+        for ( auto i = prods.begin(); i != prods.end(); ) {
+            uint64_t block_size = 0;
+            auto j = i;
+
+            for ( ; j != prods.end(); ++j ) {
+                auto n = fixedInputSize(*j);
+                if ( ! n )
+                    break;
+
+                block_size += *n;
+            }
+
+            if ( j - i < 2 ) {
+                parseProduction(*i++);
+                continue;
+            }
+
+            builder()->addComment(fmt("Block of %d fixed-size fields with %" PRIu64 " bytes", j - i, block_size));
+
+            auto pstate = state();
+            pstate.have_fixed_input =
+                builder()->addTmp("have_fixed_input", builder::greaterEqual(builder::size(state().cur),
+                                                                            builder::integer(block_size)));
+            pushState(std::move(pstate));
+
+            for ( ; i != j; ++i )
+                parseProduction(*i);
+
+            popState();
+        }
+    }
+
     // Retrieve a look-ahead symbol. Once the code generated by the function
     // has executed, the parsing state will reflect what look-ahead has been
     // found, including `EOD` if `cur` is the end-of-data, and `None` if no
@@ -572,31 +678,83 @@ struct ProductionVisitor
         auto& lahs = lp.lookAheads();
         auto tokens = hilti::util::set_union(lahs.first, lahs.second);
 
-        auto regexps = std::vector<Production>();
+        auto regexps = std::vector<std::vector<std::string>>();
+
+        for ( const auto& p : tokens ) {
+            if ( auto c = p.tryAs<production::Ctor>() ) {
+                if ( auto re = c->ctor().tryAs<hilti::ctor::RegExp>() )
+                    regexps.push_back(re->value());
+            }
+        }
+
+        // Returns true if any regexp token can match a byte literal in full.
+        // Both then match the same input at the same length, which we need
+        // to report as ambiguous just like for two literals. The joint
+        // regular expression would silently pick one of them instead.
+        auto ambiguous_with_regexp = [&](const std::string& literal) {
+            for ( const auto& r : regexps ) {
+                try {
+                    auto ms = hilti::rt::RegExp(r, hilti::rt::regexp::Flags({.no_sub = 1})).tokenMatcher();
+                    auto [rc, consumed] = ms.advance(hilti::rt::Bytes(std::string(literal)), true);
+
+                    if ( rc > 0 && consumed == literal.size() )
+                        return true;
+                } catch ( const hilti::rt::regexp::PatternError& ) {
+                    return true; // be conservative, the regexp will be reported elsewhere
+                }
+            }
+
+            return false;
+        };
+
+        // Byte literals go into the same joint regular expression as
+        // regexp tokens, so that a single pass over the input decides
+        // between all of them. We leave out those that a regexp could
+        // match as well.
+        auto patterns = [&](const Production& p) -> std::optional<std::vector<std::string>> {
+            auto c = p.tryAs<production::Ctor>();
+            if ( ! c )
+                return {};
+
+            if ( auto re = c->ctor().tryAs<hilti::ctor::RegExp>() )
+                return re->value();
+
+            if ( auto b = c->ctor().tryAs<hilti::ctor::Bytes>();
+                 b && b->value().size() && ! ambiguous_with_regexp(b->value()) ) {
+                std::string pattern;
+
+                for ( auto x : b->value() )
+                    pattern += (isalnum(static_cast<unsigned char>(x)) ? std::string(1, x) :
+                                                                         fmt("\\x%02x", static_cast<uint8_t>(x)));
+
+                return std::vector<std::string>{std::move(pattern)};
+            }
+
+            return {};
+        };
+
+        auto joint = std::vector<std::pair<Production, std::vector<std::string>>>();
         auto other = std::vector<Production>();
-        std::partition_copy(tokens.begin(), tokens.end(), std::back_inserter(regexps), std::back_inserter(other),
-                            [](auto& p) { return p.type()->template isA<hilti::type::RegExp>(); });
+
+        for ( const auto& p : tokens ) {
+            if ( auto x = patterns(p) )
+                joint.emplace_back(p, std::move(*x));
+            else
+                other.push_back(p);
+        }
 
         bool first_token = true;
 
-        // Parse regexps in parallel.
-        if ( ! regexps.empty() ) {
+        // Parse regexps and byte literals in parallel.
+        if ( ! joint.empty() ) {
             first_token = false;
 
             // Create the joint regular expression. The token IDs become the regexps' IDs.
-            auto patterns = hilti::util::transform(regexps, [](const auto& c) {
-                return std::make_pair(c.template as<production::Ctor>()
-                                          .ctor()
-                                          .template as<hilti::ctor::RegExp>()
-                                          .value(),
-                                      c.tokenID());
-            });
-
             auto flattened = std::vector<std::string>();
 
-            for ( const auto& p : patterns ) {
-                for ( const auto& r : p.first )
-                    flattened.push_back(hilti::util::fmt("%s{#%" PRId64 "}", r, p.second));
+            for ( const auto& [p, rs] : joint ) {
+                for ( const auto& r : rs )
+                    flattened.push_back(hilti::util::fmt("%s{#%" PRId64 "}", r, p.tokenID()));
             }
 
             auto re = hilti::ID(fmt("__re_%" PRId64, lp.symbol()));
@@ -645,7 +803,7 @@ struct ProductionVisitor
             popBuilder(); // End of switch body
         }
 
-        // Parse non-regexps successively.
+        // Parse remaining literals successively.
         for ( auto& p : other ) {
             if ( ! p.isLiteral() )
                 continue;
@@ -706,8 +864,20 @@ struct ProductionVisitor
     void operator()(const production::Epsilon& /* p */) {}
 
     void operator()(const production::Counter& p) {
-        auto body = builder()->addWhile(builder::local("__i", hilti::type::UnsignedInteger(64), p.expression()),
-                                        builder::id("__i"));
+        auto count = builder()->addTmp("count", hilti::type::UnsignedInteger(64), p.expression());
+
+        if ( const auto& c = p.body().meta().container();
+             c && destination() && ! c->isTransient() &&
+             hilti::type::effectiveType(c->itemType()).isA<hilti::type::Vector>() )
+            // We know how many elements are coming, so make space for them
+            // all at once. We cap that though, as the count may come from
+            // untrusted input.
+            builder()->addExpression(
+                builder::memberCall(*destination(), "reserve",
+                                    {builder::min(count, builder::integer(MaximumCounterReservation))}));
+
+        auto body =
+            builder()->addWhile(builder::local("__i", hilti::type::UnsignedInteger(64), count), builder::id("__i"));
 
         pushBuilder(body);
         body->addExpression(builder::decrementPostfix(builder::id("__i")));
@@ -778,10 +948,12 @@ struct ProductionVisitor
             pushState(std::move(pstate));
         }
 
-        for ( const auto& i : p.fields() )
-            parseProduction(i);
+        auto profiler = pb->startProfiler(fmt("spicy/unit/%s", state().unit_id));
+
+        parseSequence(p.fields());
 
         pb->finalizeUnit(true, p.location());
+        pb->stopProfiler(profiler);
         popState();
 
         if ( p.unitType().usesRandomAccess() )
@@ -858,10 +1030,7 @@ struct ProductionVisitor
         popBuilder();
     }
 
-    void operator()(const production::Sequence& p) {
-        for ( const auto& i : p.sequence() )
-            parseProduction(i);
-    }
+    void operator()(const production::Sequence& p) { parseSequence(p.sequence()); }
 
     void operator()(const production::Variable& p) { pb->parseType(p.type(), p.meta(), destination()); }
 };
@@ -1025,6 +1194,49 @@ Expression ParserBuilder::parseMethodExternalOverload2(const type::Unit& t) {
     return hilti::expression::UnresolvedID(std::move(id));
 }
 
+std::optional<Expression> ParserBuilder::synchronizationLiteral(const type::Unit& t) {
+    const auto& grammar = cg()->grammarBuilder()->grammar(t);
+    if ( ! grammar.root() )
+        return {};
+
+    // Collect all bytes literals that an instance of the unit may start with
+    // and that have been marked as synchronization points, either directly
+    // or through a field on the way down to them. Starting to parse at any
+    // of them will have the parser take a valid path through the grammar.
+    std::map<std::string, Expression> literals;
+    std::set<std::string> visited;
+
+    std::function<void(const Production&, bool)> first = [&](const Production& p, bool sync) {
+        if ( auto r = p.tryAs<production::Resolved>() )
+            return first(grammar.resolved(*r), sync);
+
+        sync = sync || p.maySynchronize();
+
+        if ( auto c = p.tryAs<production::Ctor>() ) {
+            if ( sync && c->ctor().tryAs<hilti::ctor::Bytes>() )
+                literals.emplace(fmt("%s", c->ctor()), c->expression());
+
+            return;
+        }
+
+        if ( p.atomic() || (! p.symbol().empty() && ! visited.insert(p.symbol()).second) )
+            return;
+
+        for ( const auto& rhs : p.rhss() ) {
+            if ( ! rhs.empty() )
+                first(rhs.front(), sync);
+        }
+    };
+
+    first(*grammar.root(), false);
+
+    // The host application searches for a single literal only.
+    if ( literals.size() != 1 )
+        return {};
+
+    return literals.begin()->second;
+}
+
 void ParserBuilder::newValueForField(const type::unit::item::Field& field, const Expression& value) {
     if ( value.type().isA<type::Void>() ) {
         // Special-case: No value parsed, but still run hook.
@@ -1215,10 +1427,38 @@ Expression ParserBuilder::waitForInputOrEod(const Expression& min) {
 }
 
 void ParserBuilder::waitForInput(const Expression& min, const std::string& error_msg, const Meta& location) {
+    if ( state().have_fixed_input ) {
+        // The enclosing block of fixed-size fields has already checked
+        // that all of its input is available. Only if it isn't, we fall
+        // back to waiting field by field.
+        pushBuilder(builder()->addIf(builder::not_(*state().have_fixed_input)), [&]() {
+            builder()->addCall("spicy_rt::waitForInput", {state().data, state().cur, min, builder::string(error_msg),
+                                                          builder::expression(location), _filters(state())});
+        });
+
+        return;
+    }
+
     builder()->addCall("spicy_rt::waitForInput", {state().data, state().cur, min, builder::string(error_msg),
                                                   builder::expression(location), _filters(state())});
 }
 
+std::optional<Expression> ParserBuilder::startProfiler(const std::string& name) {
+    if ( ! options().enable_profiling )
+        return {};
+
+    auto offset = builder::memberCall(state().cur, "offset", {});
+    return builder()->addTmp("profiler", builder::call("hilti::profiler_start", {builder::string(name), offset}));
+}
+
+void ParserBuilder::stopProfiler(const std::optional<Expression>& profiler) {
+    if ( ! profiler )
+        return;
+
+    auto offset = builder::memberCall(state().cur, "offset", {});
+    builder()->addCall("hilti::profiler_stop", {*profiler, offset});
+}
+
 void ParserBuilder::waitForEod() {
     builder()->addCall("spicy_rt::waitForEod", {state().data, state().cur, _filters(state())});
 }
@@ -116,18 +116,35 @@ struct Visitor : public hilti::visitor::PreOrder<Expression, Visitor> {
 
         std::vector<Expression> extracted_bits;
 
-        for ( const auto& b : t.bits() ) {
-            auto bit_order = builder::id("spicy_rt::BitOrder::LSB0");
+        auto bit_order = builder::id("spicy_rt::BitOrder::LSB0");
+        std::optional<ID> bit_order_label = ID("LSB0");
+
+        if ( const auto& a = AttributeSet::find(meta.field()->attributes(), "&bit-order") ) {
+            bit_order = *a->valueAs<spicy::Expression>();
+            bit_order_label = hilti::expression::constantEnumLabel(bit_order);
+        }
+        else if ( const auto& p = state().unit.get().propertyItem("%bit-order") ) {
+            bit_order = *p->expression();
+            bit_order_label = hilti::expression::constantEnumLabel(bit_order);
+        }
 
-            if ( const auto& a = AttributeSet::find(meta.field()->attributes(), "&bit-order") )
-                bit_order = *a->valueAs<spicy::Expression>();
-            else if ( const auto& p = state().unit.get().propertyItem("%bit-order") )
-                bit_order = *p->expression();
+        for ( const auto& b : t.bits() ) {
+            auto lower = b.lower();
+            auto upper = b.upper();
+            auto order = bit_order;
+
+            if ( bit_order_label && *bit_order_label == ID("MSB0") ) {
+                // Bit order is known, so we can translate the range into
+                // LSB0 right here. That leaves the runtime with just a
+                // constant shift and mask to apply.
+                lower = t.width() - b.upper() - 1;
+                upper = t.width() - b.lower() - 1;
+                order = builder::id("spicy_rt::BitOrder::LSB0");
+            }
 
-            auto x =
-                builder()->addTmp("bits", itype,
-                                  builder::call("spicy_rt::extractBits", {value, builder::integer(b.lower()),
-                                                                          builder::integer(b.upper()), bit_order}));
+            auto x = builder()->addTmp("bits", itype,
+                                       builder::call("spicy_rt::extractBits", {value, builder::integer(lower),
+                                                                               builder::integer(upper), order}));
 
             if ( auto a = AttributeSet::find(b.attributes(), "&convert") ) {
                 auto converted = builder()->addTmp(ID("converted"), b.type());
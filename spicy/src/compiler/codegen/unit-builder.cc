@@ -221,6 +221,10 @@ Type CodeGen::compileUnit(const type::Unit& unit, bool declare_only) {
         if ( unit.parameters().empty() )
             parse1 = _pb.parseMethodExternalOverload1(unit);
 
+        Expression synchronize_at = builder::optional(hilti::type::Bytes());
+        if ( auto l = _pb.synchronizationLiteral(unit) )
+            synchronize_at = builder::optional(*l);
+
         auto parser =
             builder::struct_({{ID("name"), builder::string(*unit.typeID())},
                               {ID("parse1"), parse1},
@@ -228,7 +232,8 @@ Type CodeGen::compileUnit(const type::Unit& unit, bool declare_only) {
                               {ID("description"), (description ? *description->expression() : builder::string(""))},
                               {ID("mime_types"),
                                builder::vector(builder::typeByID("spicy_rt::MIMEType"), std::move(mime_types))},
-                              {ID("ports"), builder::vector(ports)}},
+                              {ID("ports"), builder::vector(ports)},
+                              {ID("synchronize_at"), synchronize_at}},
                              unit.meta());
 
         builder.addAssign(builder::id(ID(*unit.typeID(), "__parser")), parser);
@@ -266,6 +266,7 @@ void Sink::_tryDeliver(ChunkList::iterator c) {
 
 void Sink::_reportGap(uint64_t rseq, uint64_t len) const {
     SPICY_RT_DEBUG_VERBOSE(fmt("reporting gap in sink %p at rseq %" PRIu64, this, rseq));
+    ++_total_gaps;
 
     for ( size_t i = 0; i < _states.size(); i++ )
         (*_states[i]->parser->__hook_gap)(_units[i], _aseq(rseq), len);
@@ -273,6 +274,7 @@ void Sink::_reportGap(uint64_t rseq, uint64_t len) const {
 
 void Sink::_reportOverlap(uint64_t rseq, const hilti::rt::Bytes& old, const hilti::rt::Bytes& new_) const {
     SPICY_RT_DEBUG_VERBOSE(fmt("reporting overlap in sink %p at rseq %" PRIu64, this, rseq));
+    ++_total_overlaps;
 
     for ( size_t i = 0; i < _states.size(); i++ )
         (*_states[i]->parser->__hook_overlap)(_units[i], _aseq(rseq), old, new_);
@@ -429,6 +431,15 @@ void Sink::write(hilti::rt::Bytes data, std::optional<uint64_t> seq, std::option
         _newData(std::move(data), _cur_rseq, n);
 }
 
+Sink::Statistics Sink::statistics() {
+    Statistics stats{.buffered = _total_buffered,
+                     .max_buffered = _max_buffered,
+                     .gaps = _total_gaps,
+                     .overlaps = _total_overlaps};
+
+    return stats;
+}
+
 #if 0
 void Sink::write(const hilti::rt::Bytes& data, std::optional<uint64_t> seq, std::optional<uint64_t> len) {
     if ( ! data.size() )
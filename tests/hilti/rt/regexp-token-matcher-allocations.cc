@@ -0,0 +1,61 @@
+// @TEST-REQUIRES: ! have-sanitizer
+// @TEST-GROUP: no-jit
+// @TEST-EXEC: cxx-compile-and-link %INPUT
+// @TEST-EXEC: ./a.out >output 2>&1
+// @TEST-EXEC: btest-diff output
+//
+// Checks that token matching doesn't perform any dynamic memory allocations
+// once the DFA has computed its states. This replaces the global operator
+// new, which is why it's a program of its own.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <hilti/rt/libhilti.h>
+
+static uint64_t allocations = 0;
+
+void* operator new(std::size_t n) {
+    ++allocations;
+
+    if ( auto p = std::malloc(n) )
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t /* n */) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    hilti::rt::init();
+
+    const auto re = hilti::rt::RegExp(std::vector<std::string>({"[a-z]+X", "[0-9]+"}),
+                                      hilti::rt::regexp::Flags({.no_sub = 1}));
+    const auto stream = hilti::rt::Stream(hilti::rt::Bytes("abcdefX 123"));
+    const auto view = stream.view();
+
+    // Let the DFA compute its states first.
+    if ( std::get<0>(re.tokenMatcher().advance(view)) != 1 )
+        return 1;
+
+    auto matches = 0;
+    const auto before = allocations;
+
+    for ( auto i = 0; i < 10; i++ ) {
+        auto ms = re.tokenMatcher();
+
+        if ( std::get<0>(ms.advance(view)) == 1 )
+            ++matches;
+    }
+
+    const auto after = allocations;
+
+    printf("matches: %d\n", matches);
+    printf("allocations: %llu\n", static_cast<unsigned long long>(after - before));
+
+    hilti::rt::done();
+    return after == before ? 0 : 1;
+}
@@ -19,12 +19,14 @@ static struct option long_driver_options[] = {{"abort-on-exceptions", required_a
                                               {"debug", no_argument, nullptr, 'd'},
                                               {"debug-addl", required_argument, nullptr, 'X'},
                                               {"dump-code", no_argument, nullptr, 'C'},
+                                              {"enable-profiling", no_argument, nullptr, 'Z'},
                                               {"help", no_argument, nullptr, 'h'},
                                               {"keep-tmps", no_argument, nullptr, 'T'},
                                               {"library-path", required_argument, nullptr, 'L'},
                                               {"optimize", no_argument, nullptr, 'O'},
                                               {"output", required_argument, nullptr, 'o'},
                                               {"output-c++", required_argument, nullptr, 'c'},
+                                              {"prune-unused-fields", no_argument, nullptr, 'P'},
                                               {"report-times", required_argument, nullptr, 'R'},
                                               {"version", no_argument, nullptr, 'v'},
                                               {nullptr, 0, nullptr, 0}};
@@ -44,10 +46,14 @@ static void usage() {
                  "(comma-separated; 'help' for list).\n"
                  "  -L | --library-path <path>      Add path to list of directories to search when importing modules.\n"
                  "  -O | --optimize                 Build optimized release version of generated code.\n"
+                 "  -P | --prune-unused-fields      Do not store unit fields that neither Spicy code nor events "
+                 "access.\n"
                  "  -R | --report-times             Report a break-down of compiler's execution time.\n"
                  "  -T | --keep-tmps                Do not delete any temporary files created.\n"
                  "  -X | --debug-addl <addl>        Implies -d and adds selected additional instrumentation "
                  "(comma-separated; see 'help' for list).\n"
+                 "  -Z | --enable-profiling         Instrument generated code for profiling; Zeek reports the results "
+                 "at termination.\n"
                  "\n"
                  "Inputs can be *.spicy, *.evt, *.hlt, .cc/.cxx\n"
                  "\n";
@@ -55,10 +61,10 @@ static void usage() {
 
 using hilti::Nothing;
 
-static hilti::Result<Nothing> parseOptions(int argc, char** argv, hilti::driver::Options* driver_options,
-                                           hilti::Options* compiler_options) {
+static hilti::Result<Nothing> parseOptions(int argc, char** argv, spicy::zeek::Driver* driver,
+                                           hilti::driver::Options* driver_options, hilti::Options* compiler_options) {
     while ( true ) {
-        int c = getopt_long(argc, argv, "ABc:CdX:D:L:o:ORTvh", long_driver_options, nullptr);
+        int c = getopt_long(argc, argv, "ABc:CdX:D:L:o:OPRTvhZ", long_driver_options, nullptr);
 
         if ( c == -1 )
             break;
@@ -131,10 +137,14 @@ static hilti::Result<Nothing> parseOptions(int argc, char** argv, hilti::driver:
 
             case 'O': compiler_options->optimize = true; break;
 
+            case 'P': driver->setPruneUnusedFields(true); break;
+
             case 'R': driver_options->report_times = true; break;
 
             case 'T': driver_options->keep_tmps = true; break;
 
+            case 'Z': compiler_options->enable_profiling = true; break;
+
             case 'v':
                 std::cerr << "spicyz"
                           << " v" << hilti::configuration().version_string_long << std::endl;
@@ -189,7 +199,7 @@ int main(int argc, char** argv) {
             compiler_options.library_paths.emplace_back(dir);
     }
 
-    if ( auto rc = parseOptions(argc, argv, &driver_options, &compiler_options); ! rc ) {
+    if ( auto rc = parseOptions(argc, argv, &driver, &driver_options, &compiler_options); ! rc ) {
         hilti::logger().error(rc.error().description());
         return 1;
     }
@@ -8,6 +8,7 @@
 
 #include <hilti/ast/declarations/type.h>
 #include <spicy/ast/detail/visitor.h>
+#include <spicy/ast/types/unit-items/unresolved-field.h>
 #include <spicy/ast/types/unit.h>
 
 #include "debug.h"
@@ -70,6 +71,60 @@ struct VisitorPostCompilation : public hilti::visitor::PreOrder<void, VisitorPos
     std::vector<UnitInfo> units;
 };
 
+/** Visitor collecting the unit types of all fields that may get used as a whole. */
+struct VisitorWholeFieldUnits : public hilti::visitor::PreOrder<void, VisitorWholeFieldUnits> {
+    explicit VisitorWholeFieldUnits(hilti::ID module, glue::FieldReferences* refs)
+        : module(std::move(module)), refs(refs) {}
+
+    struct VisitorCollectIDs : public hilti::visitor::PreOrder<void, VisitorCollectIDs> {
+        void operator()(const hilti::ID& n) { ids.push_back(n); }
+        std::vector<hilti::ID> ids;
+    };
+
+    void operator()(const spicy::type::unit::item::UnresolvedField& n) {
+        if ( ! n.fieldID() || ! refs->whole_fields.count(*n.fieldID()) )
+            return;
+
+        // Any ID inside the field's type may name a unit, so be conservative
+        // and take them all.
+        auto v = VisitorCollectIDs();
+        for ( auto i : v.walk(n.childs()[0]) )
+            v.dispatch(i);
+
+        for ( const auto& id : v.ids )
+            refs->units.insert(id.namespace_().empty() ? hilti::ID(module, id) : id);
+    }
+
+    hilti::ID module;
+    glue::FieldReferences* refs;
+};
+
+/** Visitor marking all unit fields that aren't accessed as transient. */
+struct VisitorPruneFields : public hilti::visitor::PostOrder<void, VisitorPruneFields> {
+    explicit VisitorPruneFields(hilti::ID module, const glue::FieldReferences& refs)
+        : module(std::move(module)), refs(refs) {}
+
+    void operator()(const spicy::type::unit::item::UnresolvedField& n, position_t p) {
+        auto id = n.fieldID();
+        if ( ! id || refs.fields.count(*id) || hilti::AttributeSet::has(n.attributes(), "&no-emit") )
+            return;
+
+        // Leave units alone that may get used as a whole, as all their
+        // fields may end up being accessed.
+        auto t = p.findParent<hilti::declaration::Type>();
+        if ( ! t || refs.units.count(hilti::ID(module, t->get().id())) )
+            return;
+
+        ZEEK_DEBUG(hilti::util::fmt("  Field '%s' is never accessed, making it transient", *id));
+
+        auto attrs = *hilti::AttributeSet::add(n.attributes(), hilti::Attribute("&no-emit"));
+        p.node = spicy::type::unit::item::to_node(spicy::type::unit::item::UnresolvedField::setAttributes(n, attrs));
+    }
+
+    hilti::ID module;
+    const glue::FieldReferences& refs;
+};
+
 Driver::Driver(const std::string& argv0) : hilti::Driver("<Spicy Plugin for Zeek>") {
     if ( argv0.size() )
         hilti::configuration().initLocation(argv0);
@@ -196,6 +251,8 @@ hilti::Result<hilti::Nothing> Driver::parseOptionsPostScript(const std::string&
 
             case 'V': compiler_options->skip_validation = true; break;
 
+            case 'Z': compiler_options->enable_profiling = true; break;
+
             case 'X': {
                 if ( idx >= argc )
                     return hilti::result::Error("argument missing");
@@ -272,6 +329,11 @@ hilti::Result<hilti::Nothing> Driver::compile() {
 
     ZEEK_DEBUG("Running Spicy driver");
 
+    if ( _prune_unused_fields ) {
+        if ( auto x = _pruneUnusedFields(); ! x )
+            return x.error();
+    }
+
     if ( auto x = hilti::Driver::compile(); ! x )
         return x.error();
 
@@ -279,6 +341,43 @@ hilti::Result<hilti::Nothing> Driver::compile() {
     return hilti::Nothing();
 }
 
+hilti::Result<hilti::Nothing> Driver::_pruneUnusedFields() {
+    auto refs = _glue->referencedFields();
+    if ( ! refs )
+        return refs.error();
+
+    std::vector<std::pair<hilti::ID, hilti::NodeRef>> modules;
+
+    for ( const auto& id : _spicy_modules ) {
+        if ( auto m = context()->lookupModule(id) )
+            modules.emplace_back(id, m->node);
+    }
+
+    for ( const auto& [id, m] : modules )
+        glue::collectFieldReferences(*m, id, {}, &*refs);
+
+    for ( const auto& [id, m] : modules ) {
+        auto v = VisitorWholeFieldUnits(id, &*refs);
+        for ( auto i : v.walk(*m) )
+            v.dispatch(i);
+    }
+
+    if ( refs->any_unit ) {
+        ZEEK_DEBUG("Not pruning unused unit fields, a unit may get used as a whole");
+        return hilti::Nothing();
+    }
+
+    ZEEK_DEBUG("Pruning unused unit fields");
+
+    for ( auto& [id, m] : modules ) {
+        auto v = VisitorPruneFields(id, *refs);
+        for ( auto i : v.walk(&*m) )
+            v.dispatch(i);
+    }
+
+    return hilti::Nothing();
+}
+
 hilti::Result<UnitInfo> Driver::lookupUnit(const hilti::ID& unit) {
     if ( auto x = _units.find(unit); x != _units.end() )
         return x->second;
@@ -292,6 +391,9 @@ void Driver::hookNewASTPreCompilation(const ID& id, const std::optional<std::fil
         // Ignore modules constructed in memory.
         return;
 
+    if ( path->extension() == ".spicy" )
+        _spicy_modules.push_back(id);
+
     auto v = VisitorPreCompilation(this, id, *path);
     for ( auto i : v.walk(root) )
         v.dispatch(i);
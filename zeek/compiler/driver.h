@@ -76,6 +76,19 @@ public:
      */
     const std::vector<EnumInfo>& publicEnumTypes() { return _enums; }
 
+    /**
+     * Enables removal of unit fields that are never accessed. When enabled,
+     * `compile()` first determines all unit fields that any of the loaded
+     * Spicy modules or `*.evt` files reference, and then turns all other
+     * fields of units defined in loaded Spicy modules into transient ones:
+     * they will still be parsed, but their values won't be stored.
+     *
+     * This must be called before `compile()`.
+     *
+     * @param enable true to enable the optimization
+     */
+    void setPruneUnusedFields(bool enable) { _prune_unused_fields = enable; }
+
     /**
      * Parses some options command-line style *before* Zeek-side scripts have
      * been processed. Most of the option processing happens in
@@ -141,11 +154,16 @@ protected:
 
     std::map<hilti::ID, UnitInfo> _units;
     std::vector<EnumInfo> _enums;
+    std::vector<hilti::ID> _spicy_modules; // IDs of Spicy modules loaded directly
 
     std::shared_ptr<hilti::Context> _context;
     std::unique_ptr<GlueCompiler> _glue;
 
-    bool _need_glue = true; // true if glue code has not yet been generated
+    bool _need_glue = true;            // true if glue code has not yet been generated
+    bool _prune_unused_fields = false; // true to turn unused unit fields into transient ones
+
+private:
+    hilti::Result<hilti::Nothing> _pruneUnusedFields();
 };
 
 } // namespace spicy::zeek
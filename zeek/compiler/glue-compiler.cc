@@ -6,6 +6,9 @@
 #include <hilti/ast/builder/all.h>
 #include <hilti/base/util.h>
 #include <hilti/compiler/unit.h>
+#include <spicy/ast/detail/visitor.h>
+#include <spicy/ast/types/unit-items/unit-hook.h>
+#include <spicy/ast/types/unit-items/unresolved-field.h>
 #include <spicy/global.h>
 
 #include "debug.h"
@@ -188,6 +191,39 @@ static std::string extract_expr(const std::string& chunk, size_t* i) {
     return expr;
 }
 
+static std::string extract_regexp(const std::string& chunk, size_t* i) {
+    eat_spaces(chunk, i);
+
+    if ( *i >= chunk.size() || chunk[*i] != '/' )
+        throw ParseError("expected regular expression");
+
+    std::string re;
+    size_t j = *i + 1;
+
+    for ( ; j < chunk.size() && chunk[j] != '/'; ++j ) {
+        if ( chunk[j] == '\\' && j + 1 < chunk.size() && chunk[j + 1] == '/' )
+            // Escaped slash, which jrx doesn't need escaped.
+            ++j;
+
+        re += chunk[j];
+    }
+
+    if ( j >= chunk.size() )
+        throw ParseError("unterminated regular expression");
+
+    if ( re.empty() )
+        throw ParseError("empty regular expression");
+
+    *i = j + 1;
+    return re;
+}
+
+// Returns a HILTI vector of the given strings.
+static hilti::Expression strings(const std::vector<std::string>& v) {
+    return builder::vector(hilti::type::String(),
+                           hilti::util::transform(v, [](const auto& x) { return builder::string(x); }));
+}
+
 static hilti::rt::Port extract_port(const std::string& chunk, size_t* i) {
     eat_spaces(chunk, i);
 
@@ -489,6 +525,26 @@ glue::ProtocolAnalyzer GlueCompiler::parseProtocolAnalyzer(const std::string& ch
             a.replaces = extract_id(chunk, &i);
         }
 
+        else if ( looking_at(chunk, i, "sniff") ) {
+            eat_token(chunk, &i, "sniff");
+
+            if ( looking_at(chunk, i, "originator") ) {
+                eat_token(chunk, &i, "originator");
+                a.sniff_orig.push_back(extract_regexp(chunk, &i));
+            }
+
+            else if ( looking_at(chunk, i, "responder") ) {
+                eat_token(chunk, &i, "responder");
+                a.sniff_resp.push_back(extract_regexp(chunk, &i));
+            }
+
+            else {
+                auto re = extract_regexp(chunk, &i);
+                a.sniff_orig.push_back(re);
+                a.sniff_resp.push_back(re);
+            }
+        }
+
         else
             throw ParseError("unexpect token");
 
@@ -648,7 +704,7 @@ bool GlueCompiler::compile() {
                           {builder::string(a.name), builder::id(protocol),
                            builder::vector(hilti::util::transform(a.ports, [](auto p) { return builder::port(p); })),
                            builder::string(a.unit_name_orig), builder::string(a.unit_name_resp),
-                           builder::string(a.replaces)});
+                           builder::string(a.replaces), strings(a.sniff_orig), strings(a.sniff_resp)});
 
         init_module.add(std::move(register_));
     }
@@ -831,6 +887,157 @@ static hilti::Result<hilti::Expression> _parseArgument(const std::string& expres
     return n.as<hilti::Expression>();
 }
 
+// Helper visitor to collect the unit fields and units that an AST accesses.
+struct CollectFieldReferencesVisitor : public hilti::visitor::PreOrder<void, CollectFieldReferencesVisitor> {
+    CollectFieldReferencesVisitor(hilti::ID module, const std::vector<hilti::ID>& self_units,
+                                  glue::FieldReferences* refs)
+        : module(std::move(module)), self_units(self_units), refs(refs) {}
+
+    // Returns true if a node is the operand that a member operator accesses.
+    static bool isMemberOperand(const hilti::Node& n, const hilti::Node& parent) {
+        auto op = parent.tryAs<hilti::expression::UnresolvedOperator>();
+        if ( ! op )
+            return false;
+
+        switch ( op->kind() ) {
+            case hilti::operator_::Kind::HasMember:
+            case hilti::operator_::Kind::Member:
+            case hilti::operator_::Kind::MemberCall:
+            case hilti::operator_::Kind::TryMember: return &parent.childs()[0] == &n;
+            default: return false;
+        }
+    }
+
+    // Returns true if the node at a position gets used as a whole, rather
+    // than just having one of its members accessed.
+    static bool isUsedWhole(const_position_t p) {
+        return p.pathLength() < 2 || ! isMemberOperand(p.node, p.parent());
+    }
+
+    hilti::ID qualify(const hilti::ID& id) const {
+        if ( module.empty() || ! id.namespace_().empty() )
+            return id;
+
+        return hilti::ID(module, id);
+    }
+
+    void self(const_position_t p) {
+        if ( ! isUsedWhole(p) )
+            return;
+
+        if ( auto h = p.findParent<spicy::declaration::UnitHook>() )
+            refs->units.insert(qualify(h->get().id().namespace_()));
+        else if ( auto t = p.findParent<hilti::declaration::Type>() )
+            refs->units.insert(qualify(t->get().id()));
+        else if ( self_units.size() )
+            refs->units.insert(self_units.begin(), self_units.end());
+        else
+            refs->any_unit = true;
+    }
+
+    void dollarDollar(const_position_t p) {
+        if ( ! isUsedWhole(p) )
+            return;
+
+        if ( auto h = p.findParent<spicy::type::unit::item::UnitHook>() )
+            refs->whole_fields.insert(h->get().id().local());
+        else if ( auto f = p.findParent<spicy::type::unit::item::UnresolvedField>(); f && f->get().fieldID() )
+            refs->whole_fields.insert(*f->get().fieldID());
+        else
+            refs->any_unit = true;
+    }
+
+    void operator()(const hilti::expression::UnresolvedID& n, const_position_t p) {
+        if ( n.id() == hilti::ID("self") )
+            self(p);
+    }
+
+    void operator()(const hilti::expression::Keyword& n, const_position_t p) {
+        switch ( n.kind() ) {
+            case hilti::expression::keyword::Kind::Self: self(p); break;
+            case hilti::expression::keyword::Kind::DollarDollar: dollarDollar(p); break;
+        }
+    }
+
+    void operator()(const hilti::expression::Member& n, const_position_t p) {
+        refs->fields.insert(n.id());
+
+        // If this is a field access, see if the field's value gets used as a
+        // whole, which is what matters if it's a unit itself.
+        if ( p.pathLength() < 2 )
+            return;
+
+        auto op = p.parent().tryAs<hilti::expression::UnresolvedOperator>();
+        if ( ! op ||
+             (op->kind() != hilti::operator_::Kind::Member && op->kind() != hilti::operator_::Kind::TryMember) )
+            return;
+
+        if ( p.pathLength() < 3 || ! isMemberOperand(p.parent(), p.parent(2)) )
+            refs->whole_fields.insert(n.id());
+    }
+
+    void operator()(const spicy::declaration::UnitHook& n) { refs->fields.insert(n.id().local()); }
+    void operator()(const spicy::type::unit::item::UnitHook& n) { refs->fields.insert(n.id()); }
+
+    void operator()(const spicy::type::unit::item::UnresolvedField& n) {
+        // A field with hooks attached needs its value.
+        if ( n.fieldID() && ! n.hooks().empty() )
+            refs->fields.insert(*n.fieldID());
+    }
+
+    hilti::ID module;
+    const std::vector<hilti::ID>& self_units;
+    glue::FieldReferences* refs;
+};
+
+void glue::collectFieldReferences(const hilti::Node& root, const hilti::ID& module,
+                                  const std::vector<hilti::ID>& self_units, FieldReferences* refs) {
+    auto v = CollectFieldReferencesVisitor(module, self_units, refs);
+    for ( auto i : v.walk(root) )
+        v.dispatch(i);
+}
+
+hilti::Result<glue::FieldReferences> GlueCompiler::referencedFields() const {
+    glue::FieldReferences refs;
+
+    for ( const auto& ev : _events ) {
+        auto meta = Meta(ev.location);
+
+        // A hook attached to a field needs the field's value.
+        refs.fields.insert(ev.path.local());
+
+        // We don't know yet if the event's hook is a unit's own or attached
+        // to a field, so `self` may refer to either.
+        auto self_units = std::vector<hilti::ID>{ev.path, ev.path.namespace_()};
+
+        auto collect = [&](const std::string& expression) -> hilti::Result<hilti::Nothing> {
+            auto expr = spicy::parseExpression(expression, meta);
+            if ( ! expr )
+                return hilti::result::Error(hilti::util::fmt("error parsing expression '%s'", expression));
+
+            glue::collectFieldReferences(hilti::Node(*expr), hilti::ID(), self_units, &refs);
+            return hilti::Nothing();
+        };
+
+        if ( ev.condition.size() ) {
+            if ( auto rc = collect(ev.condition); ! rc )
+                return rc.error();
+        }
+
+        for ( const auto& e : ev.exprs ) {
+            // Reserved IDs like `$conn` aren't Spicy expressions, and don't
+            // access the unit; see CreateSpicyHook().
+            if ( hilti::util::startsWith(e, "$") )
+                continue;
+
+            if ( auto rc = collect(e); ! rc )
+                return rc.error();
+        }
+    }
+
+    return refs;
+}
+
 bool GlueCompiler::CreateSpicyHook(glue::Event* ev) {
     auto mangled_event_name = hilti::util::fmt("%s_%p", hilti::util::replace(ev->name.str(), "::", "_"), ev);
     auto meta = Meta(ev->location);
@@ -921,9 +1128,8 @@ bool GlueCompiler::CreateSpicyHook(glue::Event* ev) {
                 return false;
             }
 
-            auto ztype = builder::call("zeek_rt::event_arg_type",
-                                       {builder::id(handler_id), builder::integer(i), location(e)}, meta);
-            val = builder::call("zeek_rt::to_val", {std::move(*expr), ztype, location(e)}, meta);
+            val = builder::call("zeek_rt::to_event_arg",
+                                {std::move(*expr), builder::id(handler_id), builder::integer(i), location(e)}, meta);
         }
 
         body.addMemberCall(builder::id("args"), "push_back", {val}, meta);
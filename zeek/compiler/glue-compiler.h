@@ -3,6 +3,8 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include <hilti/ast/declarations/function.h>
 #include <hilti/ast/expression.h>
@@ -34,6 +36,8 @@ struct ProtocolAnalyzer {
     hilti::ID unit_name_orig; /**< The fully-qualified name of the unit type to parse the originator side. */
     hilti::ID unit_name_resp; /**< The fully-qualified name of the unit type to parse the originator side. */
     std::string replaces;     /**< Name of another analyzer this one replaces. */
+    std::vector<std::string> sniff_orig; /**< Patterns the originator's payload must start with, if any. */
+    std::vector<std::string> sniff_resp; /**< Patterns the responder's payload must start with, if any. */
 
     // Computed information.
     std::optional<UnitInfo> unit_orig; /**< The type of the unit to parse the originator side. */
@@ -102,6 +106,30 @@ struct Event {
     std::vector<ExpressionAccessor> expression_accessors; /**< One HILTI function per expression to access the value. */
 };
 
+/**
+ * Unit fields and units that Spicy code or events may access, see
+ * `collectFieldReferences()`.
+ */
+struct FieldReferences {
+    std::set<hilti::ID> fields;       /**< Fields accessed by name, unqualified. */
+    std::set<hilti::ID> whole_fields; /**< Fields whose value may get used as a whole, unqualified. */
+    std::set<hilti::ID> units;        /**< Fully qualified units whose `self` may get used as a whole. */
+    bool any_unit = false;            /**< True if a whole use could not be tied to a specific unit. */
+};
+
+/**
+ * Records the unit fields that an AST accesses, along with the units that
+ * may escape as a whole, e.g. by passing `self` to an event or function.
+ * The AST must not have been resolved yet.
+ *
+ * @param root AST to inspect
+ * @param module module the AST belongs to, for qualifying unit IDs; empty if unknown
+ * @param self_units units that `self` may refer to if the AST itself doesn't tell
+ * @param refs references to extend with what's found
+ */
+extern void collectFieldReferences(const hilti::Node& root, const hilti::ID& module,
+                                   const std::vector<hilti::ID>& self_units, FieldReferences* refs);
+
 } // namespace glue
 
 /** Generates the glue code between Zeek and Spicy based on *.evt files. */
@@ -131,6 +159,18 @@ public:
      */
     bool compile();
 
+    /**
+     * Returns the unit fields that events defined by previously loaded
+     * `*.evt` files may access, either through their argument expressions,
+     * their conditions, or their hooks. Field IDs are returned unqualified
+     * (i.e., just the field names), so the result is a conservative
+     * over-approximation. Units that an event receives as a whole are
+     * included as well.
+     *
+     * @return references found, or an error if an expression could not be parsed
+     */
+    hilti::Result<glue::FieldReferences> referencedFields() const;
+
 private:
     /**
      * Extracts the next semicolon-terminated block from an input stream,
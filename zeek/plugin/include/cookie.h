@@ -8,9 +8,13 @@
 #pragma once
 
 #include <optional>
+#include <utility>
 #include <variant>
+#include <vector>
 
 // Zeek headers
+#include <EventHandler.h>
+#include <Val.h>
 #include <analyzer/Analyzer.h>
 #include <file_analysis/Analyzer.h>
 
@@ -25,6 +29,12 @@ struct ProtocolAnalyzer {
     uint64_t num_packets = 0;                 /**< number of packets seen so far */
     uint64_t analyzer_id = 0;                 /**< unique analyzer ID */
     uint64_t file_id = 0;                     /**< counter for file IDs */
+
+    /** Events raised while parsing the current chunk, queued if batching them. */
+    std::vector<std::pair<::EventHandlerPtr, std::vector<::Val*>>> events;
+
+    /** Connection record cached while batching events, for reuse until the end of the chunk. */
+    ::Val* conn_val = nullptr;
 };
 
 /** State on the current file analyzer. */
@@ -9,6 +9,7 @@
 
 // Spicy headers
 #include <hilti/rt/types/port.h>
+#include <hilti/rt/types/regexp.h>
 
 namespace spicy::rt {
 struct Parser;
@@ -40,10 +41,14 @@ public:
      * unit's parser with
      * @param replaces optional name of existing Zeek analyzder that this one replaces; the Zeek analyzer will
      * automatically be disabled
+     * @param sniff_orig optional regular expressions that the originator's payload must start with to be parsed
+     * @param sniff_resp optional regular expressions that the responder's payload must start with to be parsed
      */
     void registerProtocolAnalyzer(const std::string& name, hilti::rt::Protocol proto,
                                   const hilti::rt::Vector<hilti::rt::Port>& ports, const std::string& parser_orig,
-                                  const std::string& parser_resp, const std::string& replaces = "");
+                                  const std::string& parser_resp, const std::string& replaces = "",
+                                  const hilti::rt::Vector<std::string>& sniff_orig = {},
+                                  const hilti::rt::Vector<std::string>& sniff_resp = {});
 
     /**
      * Runtime method to register a file analyzer with its Zeek-side
@@ -73,6 +78,17 @@ public:
      */
     const spicy::rt::Parser* parserForProtocolAnalyzer(const ::analyzer::Tag& tag, bool is_orig);
 
+    /**
+     * Runtime method to retrieve the regular expression that the payload of
+     * a given Zeek protocol analyzer must start with for parsing to begin.
+     *
+     * @param analyzer requested protocol analyzer
+     * @param is_orig true if requesting the expression for a sessions' originator side, false for the responder
+     * @return compiled expression, or null if the analyzer doesn't define one for that side. The pointer will remain
+     * valid for the life-time of the process.
+     */
+    const hilti::rt::RegExp* sniffForProtocolAnalyzer(const ::analyzer::Tag& tag, bool is_orig);
+
     /**
      * Runtime method to retrieve the Spicy parser for a given Zeek file analyzer tag.
      *
@@ -104,6 +120,27 @@ public:
      */
     ::analyzer::Tag tagForFileAnalyzer(const ::analyzer::Tag& tag);
 
+    /**
+     * Runtime method to retrieve the maximum number of input bytes that a
+     * protocol analyzer may buffer per endpoint before aborting parsing.
+     *
+     * @return limit in bytes, or zero for no limit
+     */
+    uint64_t maxBufferedBytes() const { return _max_buffered_bytes; }
+
+    /**
+     * Runtime method to check whether protocol analyzers should queue the
+     * events they raise until they are done with the current chunk of
+     * input.
+     */
+    bool batchEvents() const { return _batch_events; }
+
+    /**
+     * Runtime method to check whether event arguments of record type should
+     * leave fields unset that no handler accesses.
+     */
+    bool skipUnusedFields() const { return _skip_unused_fields; }
+
 protected:
     /**
      * Adds one or more paths to search for *.spicy modules. The path will be
@@ -140,6 +177,8 @@ private:
         std::string name_replaces;
         hilti::rt::Protocol protocol = hilti::rt::Protocol::Undef;
         hilti::rt::Vector<hilti::rt::Port> ports;
+        std::optional<hilti::rt::RegExp> sniff_orig;
+        std::optional<hilti::rt::RegExp> sniff_resp;
         ::analyzer::Tag::subtype_t subtype;
 
         // Filled in during InitPostScript().
@@ -162,6 +201,9 @@ private:
 
     std::vector<ProtocolAnalyzerInfo> _protocol_analyzers_by_subtype;
     std::vector<FileAnalyzerInfo> _file_analyzers_by_subtype;
+    uint64_t _max_buffered_bytes = 0; // Filled in during InitPostScript().
+    bool _batch_events = false;       // Filled in during InitPostScript().
+    bool _skip_unused_fields = false; // Filled in during InitPostScript().
 };
 
 // Will be initalized to point to whatever type of plugin is instantiated.
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <optional>
 
 // Zeek headers
@@ -21,6 +22,18 @@ public:
     ProtocolAnalyzer(::analyzer::Analyzer* analyzer);
     virtual ~ProtocolAnalyzer();
 
+    /** Statistics about input buffered by protocol analyzers, aggregated across all instances. */
+    struct Statistics {
+        uint64_t buffered;         /**< number of input bytes currently buffered for parsing */
+        uint64_t max_buffered;     /**< high-water mark for number of input bytes buffered */
+        uint64_t limit_exceeded;   /**< number of endpoints for which parsing got aborted due to the buffer limit */
+        uint64_t synchronizations; /**< number of times parsing restarted at a synchronization point after an error */
+        uint64_t sniff_rejected;   /**< number of endpoints skipped because their payload didn't match the analyzer */
+    };
+
+    /** Returns statistics about input buffered by all protocol analyzers. */
+    static Statistics statistics() { return _statistics; }
+
 protected:
     /** Initialize analyzer.  */
     void Init();
@@ -39,8 +52,11 @@ protected:
         const spicy::rt::Parser* parser = nullptr;
         Cookie cookie;
         bool done = false;
+        bool synchronizing = false; /**< true while searching the input for a synchronization point after an error */
+        bool sniffed = false;       /**< true once the payload's beginning has been checked against the analyzer */
         std::optional<hilti::rt::ValueReference<hilti::rt::Stream>> data;
         std::optional<hilti::rt::Resumable> resumable;
+        uint64_t buffered = 0; /**< number of input bytes currently retained by `data` */
 
         /**
          * Resets the endpoint's input state so that the next data chunk will
@@ -48,9 +64,28 @@ protected:
          */
         void reset() {
             done = false;
+            synchronizing = false;
+            sniffed = false;
+            release();
+        };
+
+        /** Discards all input state, including any buffered data. */
+        void release() {
             data.reset();
             resumable.reset();
-        };
+            updateBuffered();
+        }
+
+        /**
+         * Updates the endpoint's record of how much input it is buffering,
+         * as well as the global statistics.
+         */
+        void updateBuffered() {
+            uint64_t n = data ? (*data)->size().Ref() : 0;
+            _statistics.buffered = _statistics.buffered - buffered + n;
+            _statistics.max_buffered = std::max(_statistics.max_buffered, _statistics.buffered);
+            buffered = n;
+        }
 
         /**
          * Swap direction-specific state between two endpoints. We use this
@@ -60,6 +95,8 @@ protected:
             std::swap(x->parser, y->parser);
             std::swap(x->cookie, y->cookie);
             std::swap(x->done, y->done);
+            std::swap(x->synchronizing, y->synchronizing);
+            std::swap(x->sniffed, y->sniffed);
         }
     };
 
@@ -77,6 +114,32 @@ protected:
      */
     int FeedChunk(bool is_orig, int len, const u_char* data, bool eod);
 
+    /**
+     * Checks the beginning of an endpoint's payload against the analyzer's
+     * sniffing patterns, if it has any.
+     *
+     * @param endp endpoint to operate on
+     * @param is_orig true if *endp* is the originator-side endpoint, false for the responder
+     * @param len number of bytes valid in *data*
+     * @param data pointer to the endpoint's first chunk of data
+     * @param eod true if not more data will be coming for this side of the session
+     *
+     * @return false if the payload doesn't match, meaning that it shouldn't
+     * be parsed; true otherwise
+     */
+    bool Sniff(Endpoint* endp, bool is_orig, int len, const u_char* data, bool eod);
+
+    /**
+     * Searches an endpoint's buffered input for the parser's
+     * synchronization point after a parse error, discarding all input
+     * before it.
+     *
+     * @param endp endpoint to operate on; its parser must define a synchronization point
+     * @return true if the synchronization point has been found, so that
+     * parsing can restart there; false if more input is needed
+     */
+    bool Synchronize(Endpoint* endp);
+
     /**
      * Resets an endpoint's input state so that the next data chunk will be
      * parsed just as if it were the first.
@@ -106,6 +169,8 @@ protected:
 private:
     Endpoint originator; /**< Originator-side state. */
     Endpoint responder;  /**< Responder-side state. */
+
+    inline static Statistics _statistics{};
 };
 
 /**
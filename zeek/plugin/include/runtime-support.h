@@ -7,6 +7,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include <zeek-spicy/autogen/config.h>
 
@@ -67,13 +68,32 @@ private:
     }
 };
 
+/**
+ * Zeek event handler along with the types of the event's arguments, which
+ * we look up just once when retrieving the handler.
+ */
+struct EventHandle {
+    ::EventHandlerPtr handler;        /**< Zeek's handler for the event */
+    ::type_list* arg_types = nullptr; /**< argument types, or null if the event wasn't declared at lookup time */
+
+    /**
+     * For each argument of record type, the fields that the event's
+     * handlers may access. If empty for an argument, all fields are
+     * potentially in use. Filled in only if `Spicy::skip_unused_fields` is
+     * set.
+     */
+    std::vector<std::vector<bool>> used_fields;
+};
+
 /**
  * Registers an Spicy protocol analyzer with its EVT meta information the
  * plugin's runtime.
  */
 void register_protocol_analyzer(const std::string& name, hilti::rt::Protocol proto,
                                 const hilti::rt::Vector<hilti::rt::Port>& ports, const std::string& parser_orig,
-                                const std::string& parser_resp, const std::string& replaces = "");
+                                const std::string& parser_resp, const std::string& replaces = "",
+                                const hilti::rt::Vector<std::string>& sniff_orig = {},
+                                const hilti::rt::Vector<std::string>& sniff_resp = {});
 
 /**
  * Registers an Spicy file analyzer with its EVT meta information the
@@ -87,22 +107,42 @@ void register_enum_type(const std::string& ns, const std::string& id,
                         const hilti::rt::Vector<std::tuple<std::string, hilti::rt::integer::safe<int64_t>>>& labels);
 
 /** Returns true if an event has at least one handler defined. */
-inline bool have_handler(EventHandlerPtr handler) { return static_cast<bool>(handler); }
+inline bool have_handler(const EventHandle& handle) { return static_cast<bool>(handle.handler); }
 
 /**
  * Looks up an event handler by name. This will always return a handler; if
  * none exist yet under that name, it'll be created.
  */
-::EventHandlerPtr internal_handler(const std::string& name);
+EventHandle internal_handler(const std::string& name);
+
+/**
+ * Raises a Zeek event, given the handler and arguments. If the event comes
+ * from a protocol analyzer and `Spicy::batch_events` is set, the event is
+ * queued until the analyzer is done with its current chunk of input.
+ */
+void raise_event(const EventHandle& handle, const hilti::rt::Vector<Val*>& args, std::string_view location);
 
-/** Raises a Zeek event, given the handler and arguments. */
-void raise_event(EventHandlerPtr handler, const hilti::rt::Vector<Val*>& args, std::string_view location);
+/**
+ * Passes all events that a protocol analyzer has queued in batch mode on
+ * to Zeek, and releases any further state cached for the duration of a
+ * chunk.
+ */
+void flush_events(cookie::ProtocolAnalyzer* cookie);
 
 /**
  * Returns the Zeek type of an event's i'th argument. The result's ref count
  * is not increased.
  */
-BroType* event_arg_type(EventHandlerPtr handler, uint64_t idx, std::string_view location);
+BroType* event_arg_type(const EventHandle& handle, uint64_t idx, std::string_view location);
+
+/**
+ * Converts a Spicy-side value into a Zeek value for passing as an event's
+ * i'th argument. For records, this skips fields that none of the event's
+ * handlers access, leaving them unset. The result is returned with ref
+ * count +1.
+ */
+template<typename T>
+Val* to_event_arg(const T& x, const EventHandle& handle, uint64_t idx, std::string_view location);
 
 /**
  * Retrieves the connection ID for the currently processed Zeek connection.
@@ -215,7 +255,7 @@ void file_end();
 
 // Forward-declare to_val() functions.
 template<typename T, typename std::enable_if_t<hilti::rt::is_tuple<T>::value>* = nullptr>
-Val* to_val(const T& t, BroType* target, std::string_view location);
+Val* to_val(const T& t, BroType* target, std::string_view location, const std::vector<bool>* used_fields = nullptr);
 template<typename T, typename std::enable_if_t<std::is_enum<T>::value>* = nullptr>
 Val* to_val(const T& t, BroType* target, std::string_view location);
 template<typename K, typename V>
@@ -284,6 +324,9 @@ inline Val* to_val(const std::string& s, BroType* target, std::string_view locat
     if ( target->Tag() != ::TYPE_STRING )
         throw TypeMismatch("string", target, location);
 
+    if ( s.empty() )
+        return ::val_mgr->GetEmptyString();
+
     return new ::StringVal(s);
 }
 
@@ -295,6 +338,9 @@ inline Val* to_val(const hilti::rt::Bytes& b, BroType* target, std::string_view
     if ( target->Tag() != ::TYPE_STRING )
         throw TypeMismatch("string", target, location);
 
+    if ( b.isEmpty() )
+        return ::val_mgr->GetEmptyString();
+
     return new ::StringVal(b.str());
 }
 
@@ -579,9 +625,12 @@ inline Val* to_val(const hilti::rt::Set<T>& s, BroType* target, std::string_view
 /**
  * Converts a Spicy-side tuple to a Zeek record value. The result is returned
  * with ref count +1.
+ *
+ * @param used_fields if given, flags which of the record's fields to
+ * convert; all others remain unset
  */
 template<typename T, typename std::enable_if_t<hilti::rt::is_tuple<T>::value>*>
-inline Val* to_val(const T& t, BroType* target, std::string_view location) {
+inline Val* to_val(const T& t, BroType* target, std::string_view location, const std::vector<bool>* used_fields) {
     if ( target->Tag() != ::TYPE_RECORD )
         throw TypeMismatch("tuple", target, location);
 
@@ -595,6 +644,12 @@ inline Val* to_val(const T& t, BroType* target, std::string_view location) {
     hilti::rt::tuple_for_each(t, [&](const auto& x) {
         Val* v = nullptr;
 
+        if ( used_fields && ! (*used_fields)[idx] ) {
+            // Nobody is going to look at this field.
+            idx++;
+            return;
+        }
+
         if constexpr ( std::is_same<decltype(x), const hilti::rt::Null&>::value ) {
             // "Null" turns into an unset optional record field.
         }
@@ -630,4 +685,16 @@ inline Val* to_val(const T& t, BroType* target, std::string_view location) {
     return target->AsEnumType()->GetVal(static_cast<int>(t));
 }
 
+template<typename T>
+inline Val* to_event_arg(const T& x, const EventHandle& handle, uint64_t idx, std::string_view location) {
+    auto target = event_arg_type(handle, idx, location);
+
+    if constexpr ( hilti::rt::is_tuple<T>::value ) {
+        if ( idx < handle.used_fields.size() && ! handle.used_fields[idx].empty() )
+            return to_val(x, target, location, &handle.used_fields[idx]);
+    }
+
+    return to_val(x, target, location);
+}
+
 } // namespace spicy::zeek::rt
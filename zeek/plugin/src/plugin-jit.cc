@@ -59,6 +59,7 @@ void plugin::Zeek_Spicy::Driver::_initialize() {
     hilti_options.debug = internal_const_val("Spicy::debug")->AsBool();
     hilti_options.skip_validation = internal_const_val("Spicy::skip_validation")->AsBool();
     hilti_options.optimize = internal_const_val("Spicy::optimize")->AsBool();
+    hilti_options.enable_profiling = internal_const_val("Spicy::enable_profiling")->AsBool();
     hilti_options.cxx_include_paths = {spicy::zeek::configuration::CxxZeekIncludeDirectory,
                                        spicy::zeek::configuration::CxxBrokerIncludeDirectory};
 
@@ -7,6 +7,7 @@
 #include <hilti/rt/configuration.h>
 #include <hilti/rt/init.h>
 #include <hilti/rt/library.h>
+#include <hilti/rt/profiler.h>
 #include <hilti/rt/types/vector.h>
 #include <spicy/rt/init.h>
 #include <spicy/rt/parser.h>
@@ -52,7 +53,9 @@ void plugin::Zeek_Spicy::Plugin::addLibraryPaths(const std::string& dirs) {
 void plugin::Zeek_Spicy::Plugin::registerProtocolAnalyzer(const std::string& name, hilti::rt::Protocol proto,
                                                           const hilti::rt::Vector<hilti::rt::Port>& ports,
                                                           const std::string& parser_orig,
-                                                          const std::string& parser_resp, const std::string& replaces) {
+                                                          const std::string& parser_resp, const std::string& replaces,
+                                                          const hilti::rt::Vector<std::string>& sniff_orig,
+                                                          const hilti::rt::Vector<std::string>& sniff_resp) {
     ZEEK_DEBUG(hilti::rt::fmt("Have Spicy protocol analyzer %s", name));
 
     ProtocolAnalyzerInfo info;
@@ -63,6 +66,13 @@ void plugin::Zeek_Spicy::Plugin::registerProtocolAnalyzer(const std::string& nam
     info.protocol = proto;
     info.ports = ports;
     info.subtype = _protocol_analyzers_by_subtype.size();
+
+    // Compile each side's patterns into a single DFA.
+    if ( ! sniff_orig.empty() )
+        info.sniff_orig = hilti::rt::RegExp(std::vector<std::string>(sniff_orig.begin(), sniff_orig.end()));
+
+    if ( ! sniff_resp.empty() )
+        info.sniff_resp = hilti::rt::RegExp(std::vector<std::string>(sniff_resp.begin(), sniff_resp.end()));
     _protocol_analyzers_by_subtype.push_back(std::move(info));
 
     if ( replaces.size() ) {
@@ -124,6 +134,13 @@ const spicy::rt::Parser* plugin::Zeek_Spicy::Plugin::parserForProtocolAnalyzer(c
         return _protocol_analyzers_by_subtype[tag.Subtype()].parser_resp;
 }
 
+const hilti::rt::RegExp* plugin::Zeek_Spicy::Plugin::sniffForProtocolAnalyzer(const ::analyzer::Tag& tag,
+                                                                              bool is_orig) {
+    const auto& info = _protocol_analyzers_by_subtype[tag.Subtype()];
+    const auto& sniff = (is_orig ? info.sniff_orig : info.sniff_resp);
+    return sniff ? &*sniff : nullptr;
+}
+
 const spicy::rt::Parser* plugin::Zeek_Spicy::Plugin::parserForFileAnalyzer(const ::file_analysis::Tag& tag) {
     return _file_analyzers_by_subtype[tag.Subtype()].parser;
 }
@@ -199,6 +216,10 @@ void plugin::Zeek_Spicy::Plugin::InitPostScript() {
 
     hilti::rt::configuration::set(config);
 
+    _max_buffered_bytes = internal_const_val("Spicy::max_buffered_bytes")->AsCount();
+    _batch_events = internal_const_val("Spicy::batch_events")->AsBool();
+    _skip_unused_fields = internal_const_val("Spicy::skip_unused_fields")->AsBool();
+
     try {
         hilti::rt::init();
         spicy::rt::init();
@@ -318,6 +339,9 @@ void plugin::Zeek_Spicy::Plugin::InitPostScript() {
 
 
 void plugin::Zeek_Spicy::Plugin::Done() {
+    // Does nothing unless parsers have been compiled with profiling enabled.
+    hilti::rt::profiler::report(std::cerr);
+
     ZEEK_DEBUG("Shutting down Spicy runtime");
     spicy::rt::done();
     hilti::rt::done();
@@ -26,16 +26,16 @@ ProtocolAnalyzer::ProtocolAnalyzer(::analyzer::Analyzer* analyzer) {
     responder.cookie = resp_cookie;
 }
 
-ProtocolAnalyzer::~ProtocolAnalyzer() {}
+ProtocolAnalyzer::~ProtocolAnalyzer() {
+    originator.release();
+    responder.release();
+}
 
 void ProtocolAnalyzer::Init() {}
 
 void ProtocolAnalyzer::Done() {
-    originator.data.reset();
-    originator.resumable.reset();
-
-    responder.data.reset();
-    responder.resumable.reset();
+    originator.release();
+    responder.release();
 }
 
 inline void ProtocolAnalyzer::DebugMsg(const ProtocolAnalyzer::Endpoint& endp, const std::string_view& msg, int len,
@@ -80,81 +80,132 @@ int ProtocolAnalyzer::FeedChunk(bool is_orig, int len, const u_char* data, bool
         }
     }
 
+    if ( ! endp->sniffed && ! Sniff(endp, is_orig, len, data, eod) ) {
+        // Bail out before setting up any parsing state.
+        endp->done = true;
+        return 0;
+    }
+
     int result = -1;
     bool done = false;
     bool error = false;
 
-    hilti::rt::context::saveCookie(&endp->cookie);
+    if ( ! endp->data ) {
+        // First chunk.
+        DebugMsg(*endp, "initial chunk", len, data, eod);
+        endp->data = hilti::rt::ValueReference<hilti::rt::Stream>({reinterpret_cast<const char*>(data), len});
+    }
+
+    else {
+        // Resume parsing.
+        DebugMsg(*endp, (endp->synchronizing ? "synchronizing with chunk" : "resuming with chunk"), len, data, eod);
+        assert(endp->data && (endp->resumable || endp->synchronizing));
+
+        if ( len )
+            (*endp->data)->append(reinterpret_cast<const char*>(data), len);
+    }
 
-    try {
-        if ( ! endp->data ) {
-            // First chunk.
-            DebugMsg(*endp, "initial chunk", len, data, eod);
-            endp->data = hilti::rt::ValueReference<hilti::rt::Stream>({reinterpret_cast<const char*>(data), len});
+    if ( eod )
+        (*endp->data)->freeze();
 
-            if ( eod )
-                (*endp->data)->freeze();
+    hilti::rt::context::saveCookie(&endp->cookie);
 
-            endp->resumable = endp->parser->parse1(*endp->data, {});
+    // We may go through this loop multiple times if parsing restarts after
+    // resynchronizing with the input.
+    while ( true ) {
+        try {
+            if ( endp->synchronizing && ! Synchronize(endp) )
+                // Need more input to find a synchronization point.
+                break;
+
+            if ( endp->resumable )
+                endp->resumable->resume();
+            else
+                endp->resumable = endp->parser->parse1(*endp->data, {});
+
+            if ( *endp->resumable ) {
+                // Done parsing.
+                done = true;
+                result = 1;
+            }
+
+            break;
         }
 
-        else {
-            // Resume parsing.
-            DebugMsg(*endp, "resuming with chunk", len, data, eod);
-            assert(endp->data && endp->resumable);
+        catch ( const spicy::rt::ParseError& e ) {
+            const auto& cookie = std::get<cookie::ProtocolAnalyzer>(endp->cookie);
 
-            if ( len )
-                (*endp->data)->append(reinterpret_cast<const char*>(data), len);
+            std::string s = "Spicy parse error: " + e.description();
 
-            if ( eod )
-                (*endp->data)->freeze();
+            if ( e.location().size() )
+                s += hilti::rt::fmt(" (%s)", e.location());
 
-            endp->resumable->resume();
-        }
+            DebugMsg(*endp, s.c_str());
+            reporter::weird(cookie.analyzer->Conn(), s);
+
+            if ( endp->parser->synchronize_at ) {
+                // Skip ahead to where the grammar says a new instance of the
+                // unit begins, and restart parsing from there. We skip at
+                // least one byte to guarantee progress.
+                DebugMsg(*endp, "trying to synchronize with input");
+                endp->synchronizing = true;
+                endp->resumable.reset();
+
+                auto& input = *endp->data;
+                if ( input->size() )
+                    input->trim(input->begin() + 1);
 
-        if ( *endp->resumable ) {
-            // Done parsing.
-            done = true;
-            result = 1;
+                continue;
+            }
+
+            error = true;
+            result = 0;
+            break;
         }
-    }
 
-    catch ( const spicy::rt::ParseError& e ) {
-        const auto& cookie = std::get<cookie::ProtocolAnalyzer>(endp->cookie);
+        catch ( const hilti::rt::Exception& e ) {
+            const auto& cookie = std::get<cookie::ProtocolAnalyzer>(endp->cookie);
 
-        error = true;
-        result = 0;
+            error = true;
+            result = 0;
 
-        std::string s = "Spicy parse error: " + e.description();
+            std::string msg_zeek = e.description();
 
-        if ( e.location().size() )
-            s += hilti::rt::fmt("%s (%s)", s, e.location());
+            std::string msg_dbg = msg_zeek;
+            if ( e.location().size() )
+                msg_dbg += hilti::rt::fmt(" (%s)", e.location());
 
-        DebugMsg(*endp, s.c_str());
-        reporter::weird(cookie.analyzer->Conn(), s);
+            DebugMsg(*endp, msg_dbg);
+            reporter::analyzerError(cookie.analyzer, msg_zeek,
+                                    e.location()); // this sets Zeek to skip sending any further input
+            break;
+        }
     }
 
-    catch ( const hilti::rt::Exception& e ) {
+    hilti::rt::context::clearCookie();
+
+    // Pass on any events queued in batch mode.
+    flush_events(&std::get<cookie::ProtocolAnalyzer>(endp->cookie));
+
+    endp->updateBuffered();
+
+    if ( auto limit = OurPlugin->maxBufferedBytes(); limit && endp->buffered > limit && ! (done || error) ) {
+        // Protect against a single connection making us buffer unbounded
+        // amounts of input, e.g., with a grammar that never trims its input.
         const auto& cookie = std::get<cookie::ProtocolAnalyzer>(endp->cookie);
 
         error = true;
         result = 0;
+        ++_statistics.limit_exceeded;
 
-        std::string msg_zeek = e.description();
-
-        std::string msg_dbg = msg_zeek;
-        if ( e.location().size() )
-            msg_dbg += hilti::rt::fmt("%s (%s)", msg_dbg, e.location());
+        DebugMsg(*endp, hilti::rt::fmt("input buffer limit exceeded (%" PRIu64 " > %" PRIu64 " bytes), aborting",
+                                       endp->buffered, limit));
+        reporter::weird(cookie.analyzer->Conn(), "spicy_buffer_limit_exceeded");
 
-        DebugMsg(*endp, msg_dbg);
-        reporter::analyzerError(cookie.analyzer, msg_zeek,
-                                e.location()); // this sets Zeek to skip sending any further input
+        endp->release();
     }
 
-    hilti::rt::context::clearCookie();
-
-    // TODO(robin): For now we just stop on error, later we might attempt to restart
-    // parsing.
+    // Unless the grammar tells us how to synchronize, we stop on error.
     if ( eod || done || error ) {
         DebugMsg(*endp, "done with parsing");
         endp->done = true; // Marker that we're done parsing.
@@ -163,6 +214,48 @@ int ProtocolAnalyzer::FeedChunk(bool is_orig, int len, const u_char* data, bool
     return result;
 }
 
+bool ProtocolAnalyzer::Sniff(Endpoint* endp, bool is_orig, int len, const u_char* data, bool eod) {
+    if ( ! len && ! eod )
+        // Nothing to look at yet.
+        return true;
+
+    // We check only the first chunk. If that's not enough to decide, we
+    // just go ahead and parse.
+    endp->sniffed = true;
+
+    const auto& cookie = std::get<cookie::ProtocolAnalyzer>(endp->cookie);
+    auto sniff = OurPlugin->sniffForProtocolAnalyzer(cookie.analyzer->GetAnalyzerTag(), is_orig);
+
+    if ( ! sniff )
+        return true;
+
+    auto rc = sniff->matchPrefix(reinterpret_cast<const char*>(data), len);
+
+    if ( rc > 0 || (rc < 0 && ! eod) )
+        return true;
+
+    DebugMsg(*endp, "payload does not match analyzer, skipping", len, data, eod);
+    ++_statistics.sniff_rejected;
+    return false;
+}
+
+bool ProtocolAnalyzer::Synchronize(Endpoint* endp) {
+    auto& input = *endp->data;
+    auto [found, i] = input->view().find(*endp->parser->synchronize_at);
+
+    // Whatever comes before the returned position cannot be part of a
+    // match, so we can discard it either way.
+    input->trim(i);
+
+    if ( ! found )
+        return false;
+
+    DebugMsg(*endp, "synchronized with input, restarting parsing");
+    endp->synchronizing = false;
+    ++_statistics.synchronizations;
+    return true;
+}
+
 void ProtocolAnalyzer::ResetEndpoint(bool is_orig) {
     if ( is_orig )
         originator.reset();
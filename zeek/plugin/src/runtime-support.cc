@@ -1,5 +1,9 @@
 // Copyright (c) 2020 by the Zeek Project. See LICENSE for details.
 
+#include <algorithm>
+#include <optional>
+#include <unordered_set>
+
 #include <hilti/rt/util.h>
 
 #include <zeek-spicy/autogen/config.h>
@@ -10,6 +14,10 @@
 #endif
 
 #include <EventHandler.h>
+#include <Expr.h>
+#include <Func.h>
+#include <ID.h>
+#include <Traverse.h>
 #include <Val.h>
 #include <file_analysis/File.h>
 #include <file_analysis/Manager.h>
@@ -29,8 +37,11 @@ using namespace plugin::Zeek_Spicy;
 
 void rt::register_protocol_analyzer(const std::string& name, hilti::rt::Protocol proto,
                                     const hilti::rt::Vector<hilti::rt::Port>& ports, const std::string& parser_orig,
-                                    const std::string& parser_resp, const std::string& replaces) {
-    OurPlugin->registerProtocolAnalyzer(name, proto, ports, parser_orig, parser_resp, replaces);
+                                    const std::string& parser_resp, const std::string& replaces,
+                                    const hilti::rt::Vector<std::string>& sniff_orig,
+                                    const hilti::rt::Vector<std::string>& sniff_resp) {
+    OurPlugin->registerProtocolAnalyzer(name, proto, ports, parser_orig, parser_resp, replaces, sniff_orig,
+                                        sniff_resp);
 }
 
 void rt::register_file_analyzer(const std::string& name, const hilti::rt::Vector<std::string>& mime_types,
@@ -44,7 +55,121 @@ void rt::register_enum_type(
     OurPlugin->registerEnumType(ns, id, labels);
 }
 
-::EventHandlerPtr rt::internal_handler(const std::string& name) {
+namespace {
+
+/**
+ * Determines which fields of an event's record arguments the event's
+ * handlers may access. Whenever a handler uses such an argument as a whole
+ * (e.g., passing it on to a function), we assume all of its fields to be in
+ * use.
+ */
+class FieldUsage : public TraversalCallback {
+public:
+    FieldUsage(::type_list* arg_types) : _arg_types(arg_types) {
+        for ( int i = 0; i < arg_types->length(); i++ ) {
+            auto t = (*arg_types)[i];
+            if ( t->Tag() == ::TYPE_RECORD )
+                used_fields.emplace_back(t->AsRecordType()->NumFields(), false);
+            else
+                used_fields.emplace_back();
+        }
+    }
+
+    TraversalCode PreExpr(const ::Expr* e) override {
+        switch ( e->Tag() ) {
+            case ::EXPR_FIELD: {
+                auto f = static_cast<const ::FieldExpr*>(e);
+                if ( auto idx = _recordArgument(f->Op()) ) {
+                    used_fields[*idx][f->Field()] = true;
+                    _field_accesses.insert(f->Op());
+                }
+
+                break;
+            }
+
+            case ::EXPR_HAS_FIELD: {
+                auto f = static_cast<const ::HasFieldExpr*>(e);
+                if ( auto idx = _recordArgument(f->Op()) ) {
+                    auto rtype = (*_arg_types)[*idx]->AsRecordType();
+                    if ( auto field = rtype->FieldOffset(f->FieldName()); field >= 0 )
+                        used_fields[*idx][field] = true;
+
+                    _field_accesses.insert(f->Op());
+                }
+
+                break;
+            }
+
+            case ::EXPR_NAME: {
+                if ( auto idx = _recordArgument(e); idx && ! _field_accesses.count(e) )
+                    _useAll(*idx);
+
+                break;
+            }
+
+#if ZEEK_VERSION_NUMBER >= 30100
+            case ::EXPR_LAMBDA: {
+                // We don't see into the body of lambdas, so play it safe.
+                for ( size_t i = 0; i < used_fields.size(); i++ )
+                    _useAll(i);
+
+                break;
+            }
+#endif
+
+            default: break;
+        }
+
+        return TC_CONTINUE;
+    }
+
+    std::vector<std::vector<bool>> used_fields;
+
+private:
+    // If the expression refers to one of the handler's record parameters,
+    // returns that parameter's index.
+    std::optional<size_t> _recordArgument(const ::Expr* e) const {
+        if ( e->Tag() != ::EXPR_NAME )
+            return {};
+
+        auto id = static_cast<const ::NameExpr*>(e)->Id();
+        if ( id->IsGlobal() || id->Offset() < 0 || id->Offset() >= _arg_types->length() )
+            return {};
+
+        if ( used_fields[id->Offset()].empty() )
+            return {};
+
+        return id->Offset();
+    }
+
+    void _useAll(size_t idx) { std::fill(used_fields[idx].begin(), used_fields[idx].end(), true); }
+
+    ::type_list* _arg_types;
+    std::unordered_set<const ::Expr*> _field_accesses;
+};
+
+} // namespace
+
+// Determines the record fields accessed by an event's handlers. Returns an
+// empty vector if we can't tell.
+static std::vector<std::vector<bool>> _usedFields(::EventHandlerPtr handler, ::type_list* arg_types) {
+    auto func = handler->LocalHandler();
+    if ( ! func )
+        return {};
+
+    FieldUsage usage(arg_types);
+    func->Traverse(&usage);
+
+    // Drop masks that don't save anything.
+    for ( auto& u : usage.used_fields ) {
+        if ( std::all_of(u.begin(), u.end(), [](auto x) { return x; }) )
+            u.clear();
+    }
+
+    return std::move(usage.used_fields);
+}
+
+rt::EventHandle rt::internal_handler(const std::string& name) {
     // This always succeeds to return a handler. If there's no such event
     // yet, an empty handler instance is created.
     auto ev = ::internal_handler(name.c_str());
@@ -63,34 +188,85 @@ void rt::register_enum_type(
     if ( auto id = lookup_ID(name.c_str(), mod.c_str()) )
         id->SetExport();
 
-    return ev;
+    // Scripts have been parsed at this point, so we can look up the
+    // argument types right away.
+    EventHandle handle{ev};
+
+    if ( auto ftype = ev->FType(false) ) {
+        handle.arg_types = ftype->ArgTypes()->Types();
+
+        if ( OurPlugin->skipUnusedFields() )
+            handle.used_fields = _usedFields(ev, handle.arg_types);
+    }
+
+    return handle;
+}
+
+// Returns the types of an event's arguments, preferably from the handle's cache.
+static ::type_list* _arg_types(const rt::EventHandle& handle) {
+    if ( handle.arg_types )
+        return handle.arg_types;
+
+    return handle.handler->FType()->ArgTypes()->Types();
+}
+
+static void _queue_event(EventHandlerPtr handler, const std::vector<Val*>& args) {
+    ::val_list vl(args.size());
+    for ( auto v : args )
+        vl.push_back(v);
+
+    ::mgr.QueueEventFast(handler, vl);
 }
 
-void rt::raise_event(EventHandlerPtr handler, const hilti::rt::Vector<Val*>& args, std::string_view location) {
+void rt::raise_event(const EventHandle& handle, const hilti::rt::Vector<Val*>& args, std::string_view location) {
     // Caller must have checked already that there's a handler availale.
-    assert(handler);
+    assert(handle.handler);
 
-    auto zeek_args = handler->FType()->ArgTypes()->Types();
+    auto zeek_args = _arg_types(handle);
     if ( args.size() != zeek_args->length() )
         throw TypeMismatch(fmt("expected %u parameters, but got %zu", zeek_args->length(), args.size()), location);
 
-    ::val_list vl(args.size());
+    std::vector<Val*> vals;
+    vals.reserve(args.size());
+
     for ( auto v : args ) {
         if ( v )
-            vl.push_back(v);
+            vals.push_back(v);
         else
             // Shouldn't happen here, but we have to_vals() that
             // (legitimately) return null in certain contexts.
             throw InvalidValue("null value encountered after conversion", location);
     }
 
-    ::mgr.QueueEventFast(handler, vl);
+    if ( OurPlugin->batchEvents() ) {
+        auto cookie = static_cast<Cookie*>(hilti::rt::context::cookie());
+        assert(cookie);
+
+        if ( auto x = std::get_if<cookie::ProtocolAnalyzer>(cookie) ) {
+            x->events.emplace_back(handle.handler, std::move(vals));
+            return;
+        }
+    }
+
+    _queue_event(handle.handler, vals);
+}
+
+void rt::flush_events(cookie::ProtocolAnalyzer* cookie) {
+    for ( const auto& [handler, args] : cookie->events )
+        _queue_event(handler, args);
+
+    cookie->events.clear();
+
+    if ( cookie->conn_val ) {
+        Unref(cookie->conn_val);
+        cookie->conn_val = nullptr;
+    }
 }
 
-BroType* rt::event_arg_type(EventHandlerPtr handler, uint64_t idx, std::string_view location) {
-    assert(handler);
+BroType* rt::event_arg_type(const EventHandle& handle, uint64_t idx, std::string_view location) {
+    assert(handle.handler);
 
-    auto zeek_args = handler->FType()->ArgTypes()->Types();
+    auto zeek_args = _arg_types(handle);
     if ( idx >= static_cast<uint64_t>(zeek_args->length()) )
         throw TypeMismatch(fmt("more parameters given than the %d that the Zeek event expects", zeek_args->length()),
                            location);
@@ -102,8 +278,17 @@ Val* rt::current_conn(std::string_view location) {
     auto cookie = static_cast<Cookie*>(hilti::rt::context::cookie());
     assert(cookie);
 
-    if ( auto x = std::get_if<cookie::ProtocolAnalyzer>(cookie) )
-        return x->analyzer->Conn()->BuildConnVal();
+    if ( auto x = std::get_if<cookie::ProtocolAnalyzer>(cookie) ) {
+        if ( ! OurPlugin->batchEvents() )
+            return x->analyzer->Conn()->BuildConnVal();
+
+        // When batching, all events of the current chunk get raised at the
+        // same time, so they can share a single connection record.
+        if ( ! x->conn_val )
+            x->conn_val = x->analyzer->Conn()->BuildConnVal();
+
+        return x->conn_val->Ref();
+    }
     else
         throw ValueUnavailable("$conn not available", location);
 }
@@ -167,8 +352,15 @@ void rt::flip_roles() {
 
     rt::debug(*cookie, "flipping roles");
 
-    if ( auto x = std::get_if<cookie::ProtocolAnalyzer>(cookie) )
+    if ( auto x = std::get_if<cookie::ProtocolAnalyzer>(cookie) ) {
         x->analyzer->Conn()->FlipRoles();
+
+        // Zeek rebuilds the connection record on next access.
+        if ( x->conn_val ) {
+            Unref(x->conn_val);
+            x->conn_val = nullptr;
+        }
+    }
     else
         throw ValueUnavailable("flip_roles() not available in current context");
 }